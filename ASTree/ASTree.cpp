@@ -26,6 +26,16 @@ const ASTree* ASTree::child_at(size_t n) const noexcept {
     return n < children.size() ? children[n].get() : nullptr;
 }
 
+// first child of the given type, nullptr if there is none
+const ASTree* ASTree::child_of_type(ASTNodeType type) const noexcept {
+    for(const auto& child : children){
+        if(child->get_type() == type){
+            return child.get();
+        }
+    }
+    return nullptr;
+}
+
 const std::vector<std::unique_ptr<ASTree>>& ASTree::get_children() const noexcept {
     return children;
 }
@@ -18,6 +18,7 @@ public:
     size_t children_size() const noexcept;
     
     const ASTree* child_at(size_t) const noexcept;
+    const ASTree* child_of_type(ASTNodeType) const noexcept;
     const std::vector<std::unique_ptr<ASTree>>& get_children() const noexcept;
 
     std::string ast_str() const;
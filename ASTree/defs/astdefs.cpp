@@ -14,5 +14,11 @@ const std::unordered_map<ASTNodeType, std::string> ast_node_str {
     {ASTNodeType::ASSIGNMENTS, "ASSIGNMENTS"},
     {ASTNodeType::VALUES, "VALUES"},
     {ASTNodeType::VALUE, "VALUE"},
-    {ASTNodeType::KEY, "KEY"}
+    {ASTNodeType::KEY, "KEY"},
+    {ASTNodeType::PAGESIZE, "PAGESIZE"},
+    {ASTNodeType::FILLFACTOR, "FILLFACTOR"},
+    {ASTNodeType::INDEX, "INDEX"},
+    {ASTNodeType::LIMIT, "LIMIT"},
+    {ASTNodeType::OFFSET, "OFFSET"},
+    {ASTNodeType::AGGREGATE, "AGGREGATE"}
 };
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include <unordered_map>
 #include <string>
 
-enum class ASTNodeType { SCRIPT, QUERY, SOURCE, CONDITIONS, CONDITION, ORDERBY, COLUMNS, COLUMN, TYPE, ID, ASSIGNMENTS, VALUES, VALUE, KEY };
+enum class ASTNodeType { SCRIPT, QUERY, SOURCE, CONDITIONS, CONDITION, ORDERBY, COLUMNS, COLUMN, TYPE, ID, ASSIGNMENTS, VALUES, VALUE, KEY, PAGESIZE, FILLFACTOR, INDEX, LIMIT, OFFSET, AGGREGATE };
 
 extern const std::unordered_map<ASTNodeType, std::string> ast_node_str;
 
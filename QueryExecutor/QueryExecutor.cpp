@@ -1,14 +1,139 @@
 #include "QueryExecutor.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <format>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
 
-QueryExecutor::QueryExecutor(SchemaCatalog& schema_catalog, BufferManager& buffer_manager, BTree& btree) : 
-    schema_catalog{ schema_catalog }, buffer_manager{buffer_manager}, btree{ btree } {}
+#include "../executor/Aggregate/Aggregate.hpp"
+#include "../executor/BinarySink/BinarySink.hpp"
+#include "../executor/CsvSink/CsvSink.hpp"
+#include "../executor/Filter/Filter.hpp"
+#include "../executor/Gather/Gather.hpp"
+#include "../executor/IndexScan/IndexScan.hpp"
+#include "../executor/Limit/Limit.hpp"
+#include "../executor/Project/Project.hpp"
+#include "../executor/Sort/Sort.hpp"
+#include "../executor/TableScan/TableScan.hpp"
+#include "../executor/TextSink/TextSink.hpp"
+
+namespace {
+
+constexpr size_t PARTS_PER_THREAD = 4; // parts a parallel scan is split into per thread, so threads that finish early take over the rest
+constexpr size_t FRAMES_PER_THREAD = 4; // pool frames set aside per scanning thread, each pins at most two pages at a time
+
+// comparisons name columns with ID nodes
+void condition_columns(const ASTree* condition, const TableSchema& table_schema, std::vector<bool>& referenced) {
+    if(condition->get_type() == ASTNodeType::ID){
+        referenced[table_schema.get_column_index(condition->get_token().value)] = true;
+    }
+    for(const auto& child : condition->get_children()){
+        condition_columns(child.get(), table_schema, referenced);
+    }
+}
+
+// declaration indexes of every column a SELECT reads, in ascending order, a scan decodes only these,
+// COUNT(*) on its own needs none
+std::vector<size_t> referenced_columns(const ASTree* select, const TableSchema& table_schema) {
+    std::vector<bool> referenced(table_schema.columns_size(), false);
+    for(const auto& column : select->child_at(0)->get_children()){
+        const ASTree* named{ column->get_type() == ASTNodeType::AGGREGATE ? column->child_at(0) : column.get() };
+        if(named->get_token().token_type == TokenType::ASTERISK){
+            std::fill(referenced.begin(), referenced.end(), column->get_type() != ASTNodeType::AGGREGATE);
+            continue;
+        }
+        referenced[table_schema.get_column_index(named->get_token().value)] = true;
+    }
+    if(const ASTree* conditions = select->child_of_type(ASTNodeType::CONDITIONS)){
+        condition_columns(conditions, table_schema, referenced);
+    }
+    if(const ASTree* orderby = select->child_of_type(ASTNodeType::ORDERBY)){
+        referenced[table_schema.get_column_index(orderby->get_token().value)] = true;
+    }
+    std::vector<size_t> columns;
+    for(size_t i = 0; i < referenced.size(); ++i){
+        if(referenced[i]) columns.push_back(i);
+    }
+    return columns;
+}
+
+AggregateFunction aggregate_function(TokenType token_type) noexcept {
+    switch(token_type){
+        case TokenType::SUM: return AggregateFunction::SUM;
+        case TokenType::MIN: return AggregateFunction::MIN;
+        case TokenType::MAX: return AggregateFunction::MAX;
+        default: return AggregateFunction::COUNT;
+    }
+}
+
+// fields are separated by commas, a field may be wrapped in single quotes to keep commas in it
+std::vector<std::string_view> split_row(std::string_view line) {
+    std::vector<std::string_view> fields;
+    size_t position{ 0 };
+    while(position <= line.size()){
+        while(position < line.size() && line[position] == ' ') ++position;
+        size_t end;
+        if(position < line.size() && line[position] == '\''){
+            end = line.find('\'', position + 1);
+            if(end == std::string_view::npos){
+                throw std::runtime_error("Unterminated string\n");
+            }
+            fields.push_back(line.substr(position + 1, end - position - 1));
+            end = line.find(',', end);
+        }
+        else{
+            end = line.find(',', position);
+            std::string_view field{ line.substr(position, end == std::string_view::npos ? std::string_view::npos : end - position) };
+            fields.push_back(field.substr(0, field.find_last_not_of(' ') + 1));
+        }
+        if(end == std::string_view::npos) break;
+        position = end + 1;
+    }
+    return fields;
+}
+
+// same limits the analyzer puts on literals
+void check_field(const Column& column, std::string_view field) {
+    if(column.type == DataType::VARCHAR){
+        if(field.size() >= MAX_STRING_LEN){
+            throw std::runtime_error(std::format("Maximum length of varchar is {}, received {}\n", MAX_STRING_LEN - 1, field.size()));
+        }
+        return;
+    }
+    const std::string max_num{ std::to_string(INT32_MAX) };
+    if(field.empty() || field.find_first_not_of("0123456789") != std::string_view::npos){
+        throw std::runtime_error(std::format("Expected a number for '{}', received '{}'\n", column.name, field));
+    }
+    if(field.size() > max_num.size() || (field.size() == max_num.size() && field > max_num)){
+        throw std::runtime_error(std::format("Maximum value of a number is {}, received {}\n", max_num, field));
+    }
+}
+
+std::unique_ptr<ResultSink> result_sink_for(OutputFormat output_format, std::ostream& out) {
+    switch(output_format){
+        case OutputFormat::CSV:
+            return std::make_unique<CsvSink>(out);
+        case OutputFormat::BINARY:
+            return std::make_unique<BinarySink>(out);
+        default:
+            return std::make_unique<TextSink>(out);
+    }
+}
+
+}
+
+QueryExecutor::QueryExecutor(SchemaCatalog& schema_catalog, BufferManager& buffer_manager, size_t sort_memory, OutputFormat output_format, size_t threads) : 
+    schema_catalog{ schema_catalog }, buffer_manager{buffer_manager}, planner{ schema_catalog }, sort_memory{ sort_memory },
+    result_sink{ result_sink_for(output_format, std::cout) }, thread_pool{ threads > 1 ? threads - 1 : 0 } {}
 
 void QueryExecutor::execute_script(const ASTree* script) {
     for(const auto& query : script->get_children()){
         execute_query(query.get());
     }
+    buffer_manager.commit();
 }
 
 void QueryExecutor::execute_query(const ASTree* query) {
@@ -31,6 +156,9 @@ void QueryExecutor::execute_query(const ASTree* query) {
         case TokenType::DROP:
             execute_drop(query);
             break;
+        case TokenType::COPY:
+            execute_copy(query);
+            break;
         default:
             break;
     }
@@ -39,19 +167,27 @@ void QueryExecutor::execute_query(const ASTree* query) {
 void QueryExecutor::execute_select(const ASTree* select) {
     auto table_schema = schema_catalog.get_table(select->child_at(1)->get_token().value);
     if(table_schema.has_value()){
-        std::cout << "----------------------------------------\n";
-        btree.select(std::format("{}{}.db", TABLES_PATH.generic_string(), table_schema.value().get().get_table_name()), buffer_manager, table_schema.value().get(), select);
-        std::cout << "----------------------------------------\n\n";
+        with_page_size(table_schema.value().get().get_page_size(), [&](auto page_size){
+            std::unique_ptr<Operator> pipeline{ build_pipeline<decltype(page_size)::value>(select, table_schema.value().get()) };
+            result_sink->write(*pipeline);
+        });
     }
 }
 
 void QueryExecutor::execute_create(const ASTree* create) {
+    if(create->child_at(0)->get_type() == ASTNodeType::INDEX){
+        execute_create_index(create);
+        return;
+    }
     TableSchema table_schema{ create->child_at(0)->get_token().value };
     for(const auto& column : create->child_at(1)->get_children()){
         DataType type = column->child_at(0)->get_token().token_type == TokenType::VARCHAR ? DataType::VARCHAR : DataType::NUMBER;
         Column col{column->get_token().value, type, column->get_children().back()->get_type() == ASTNodeType::KEY};
         table_schema.add_column(col);
     }
+    if(create->children_size() > 2){
+        table_schema.set_page_size(std::stoul(create->child_at(2)->get_token().value));
+    }
     buffer_manager.save_schema(SCHEMA_PATH.generic_string(), TABLES_PATH.generic_string(), table_schema);
     schema_catalog.add_table(table_schema);
 }
@@ -59,8 +195,17 @@ void QueryExecutor::execute_create(const ASTree* create) {
 void QueryExecutor::execute_insert(const ASTree* insert) {
     auto table_schema = schema_catalog.get_table(insert->child_at(0)->get_token().value);
     if(table_schema.has_value()){
-        Block block = buffer_manager.data_to_block(insert->child_at(1), insert->child_at(2), table_schema.value().get());
-        btree.insert(block, buffer_manager, std::format("{}{}.db", TABLES_PATH.generic_string(), table_schema.value().get().get_table_name()));
+        std::vector<std::vector<char>> records;
+        for(size_t i = 2; i < insert->children_size(); ++i){
+            records.push_back(buffer_manager.data_to_record(insert->child_at(1), insert->child_at(i), table_schema.value().get()));
+        }
+        with_page_size(table_schema.value().get().get_page_size(), [&](auto page_size){
+            BTree<decltype(page_size)::value> btree{ table_schema.value().get() };
+            btree.insert_batch(records, buffer_manager, std::format("{}{}.db", TABLES_PATH.generic_string(), table_schema.value().get().get_table_name()));
+            for(const auto& index : table_schema.value().get().get_indexes()){
+                SecondaryIndex<decltype(page_size)::value>{ table_schema.value().get(), index, index_path(table_schema.value().get(), index) }.insert(records, buffer_manager);
+            }
+        });
     }
 }
 
@@ -71,10 +216,213 @@ void QueryExecutor::execute_update(const ASTree* update) {
 void QueryExecutor::execute_delete(const ASTree* _delete) {
     auto table_schema = schema_catalog.get_table(_delete->child_at(0)->get_token().value);
     if(table_schema.has_value()){
-        btree.del(std::format("{}{}{}", TABLES_PATH.generic_string(), table_schema.value().get().get_table_name(), ".db"), buffer_manager, table_schema.value().get(), _delete);
+        with_page_size(table_schema.value().get().get_page_size(), [&](auto page_size){
+            BTree<decltype(page_size)::value> btree{ table_schema.value().get() };
+            const std::vector<char> removed{ btree.del(std::format("{}{}{}", TABLES_PATH.generic_string(), table_schema.value().get().get_table_name(), ".db"), buffer_manager,
+                table_schema.value().get(), _delete, plan<decltype(page_size)::value>(_delete, table_schema.value().get())) };
+            for(const auto& index : table_schema.value().get().get_indexes()){
+                SecondaryIndex<decltype(page_size)::value> secondary{ table_schema.value().get(), index, index_path(table_schema.value().get(), index) };
+                if(_delete->children_size() == 1){
+                    secondary.clear(buffer_manager);
+                }
+                else{
+                    secondary.erase(removed, buffer_manager);
+                }
+            }
+        });
     }
 }
 
 void QueryExecutor::execute_drop(const ASTree* drop) {
+    if(drop->child_at(0)->get_type() == ASTNodeType::INDEX){
+        execute_drop_index(drop);
+        return;
+    }
     buffer_manager.delete_schema(SCHEMA_PATH.generic_string(), TABLES_PATH.generic_string(), drop->child_at(0)->get_token().value, schema_catalog);
+}
+
+void QueryExecutor::execute_copy(const ASTree* copy) {
+    auto table_schema = schema_catalog.get_table(copy->child_at(0)->get_token().value);
+    if(table_schema.has_value()){
+        const std::vector<char> records{ read_rows(copy->child_at(1)->get_token().value, table_schema.value().get()) };
+        const size_t fill_factor{ copy->children_size() > 2 ? std::stoul(copy->child_at(2)->get_token().value) : MAX_FILL_FACTOR };
+        with_page_size(table_schema.value().get().get_page_size(), [&](auto page_size){
+            BTree<decltype(page_size)::value> btree{ table_schema.value().get() };
+            const std::string table_path{ std::format("{}{}.db", TABLES_PATH.generic_string(), table_schema.value().get().get_table_name()) };
+            btree.bulk_load(records, buffer_manager, table_path, fill_factor);
+            for(const auto& index : table_schema.value().get().get_indexes()){
+                SecondaryIndex<decltype(page_size)::value>{ table_schema.value().get(), index, index_path(table_schema.value().get(), index) }.build(table_path, buffer_manager);
+            }
+        });
+    }
+}
+
+// the index file starts out empty and is then filled from the rows already in the table
+void QueryExecutor::execute_create_index(const ASTree* create) {
+    const std::string& table_name{ create->child_at(1)->get_token().value };
+    const Index index{ create->child_at(0)->get_token().value, create->child_at(2)->get_token().value };
+    schema_catalog.add_index(table_name, index);
+    const TableSchema& table_schema{ schema_catalog.get_table(table_name)->get() };
+    buffer_manager.update_schema(SCHEMA_PATH.generic_string(), table_schema);
+
+    const std::string path{ index_path(table_schema, index) };
+    buffer_manager.init_table(path, table_schema.get_page_size());
+    with_page_size(table_schema.get_page_size(), [&](auto page_size){
+        SecondaryIndex<decltype(page_size)::value>{ table_schema, index, path }.build(std::format("{}{}.db", TABLES_PATH.generic_string(), table_name), buffer_manager);
+    });
+}
+
+void QueryExecutor::execute_drop_index(const ASTree* drop) {
+    const std::string& index_name{ drop->child_at(0)->get_token().value };
+    auto table_schema = schema_catalog.get_index_table(index_name);
+    if(table_schema.has_value()){
+        const std::string path{ index_path(table_schema->get(), table_schema->get().get_index(index_name)->get()) };
+        const std::string table_name{ table_schema->get().get_table_name() };
+        schema_catalog.drop_index(table_name, index_name);
+        buffer_manager.update_schema(SCHEMA_PATH.generic_string(), schema_catalog.get_table(table_name)->get());
+        buffer_manager.remove_table(path);
+    }
+}
+
+std::string QueryExecutor::index_path(const TableSchema& table_schema, const Index& index) const {
+    return std::format("{}{}.db", TABLES_PATH.generic_string(), table_schema.index_schema(index).get_table_name());
+}
+
+// an index scan reads the primary keys of the matching rows from the index before the table is touched
+template<size_t PageSize>
+AccessPath QueryExecutor::plan(const ASTree* query, const TableSchema& table_schema) {
+    AccessPath access_path{ planner.plan(query) };
+    if(access_path.method == AccessMethod::INDEX_SCAN){
+        const Index& index{ table_schema.get_index(access_path.index)->get() };
+        access_path.keys = SecondaryIndex<PageSize>{ table_schema, index, index_path(table_schema, index) }.primary_keys(access_path, buffer_manager);
+    }
+    return access_path;
+}
+
+// a full scan that filters or aggregates is split into consecutive parts of the leaf chain, one scan and WHERE condition each,
+// nothing comes back when the pool, the buffer pool or the table is too small for more than one part
+template<size_t PageSize>
+std::vector<std::unique_ptr<Operator>> QueryExecutor::scan_parts(const TableSchema& table_schema, const std::string& table_path,
+    const AccessPath& access_path, const std::vector<size_t>& columns, const ASTree* conditions, size_t& width) {
+    std::vector<std::unique_ptr<Operator>> parts;
+    width = std::min(thread_pool.size() + 1, buffer_manager.frame_count(PageSize) / FRAMES_PER_THREAD);
+    if(access_path.method != AccessMethod::FULL_SCAN || width < 2) return parts;
+
+    const std::vector<LeafSpan> spans{ BTree<PageSize>{ table_schema }.partition(table_path, buffer_manager, width * PARTS_PER_THREAD) };
+    if(spans.size() < 2) return parts;
+    for(const auto& span : spans){
+        std::unique_ptr<Operator> part{ std::make_unique<TableScan<PageSize>>(table_schema, table_path, buffer_manager, access_path, columns, span) };
+        if(conditions != nullptr){
+            part = std::make_unique<Filter>(std::move(part), conditions, table_schema);
+        }
+        parts.push_back(std::move(part));
+    }
+    return parts;
+}
+
+// scan, WHERE condition, then either the aggregates or the ORDER BY sort, LIMIT and the projection come last,
+// LIMIT stops pulling rows once it has enough, so the scan ends early unless a sort or aggregate has to see every row,
+// a full scan that filters or aggregates runs on several threads, its rows stay in key order when ORDER BY or LIMIT depend on it
+template<size_t PageSize>
+std::unique_ptr<Operator> QueryExecutor::build_pipeline(const ASTree* select, const TableSchema& table_schema) {
+    const std::string table_path{ std::format("{}{}.db", TABLES_PATH.generic_string(), table_schema.get_table_name()) };
+    const AccessPath access_path{ planner.plan(select) };
+    const std::vector<size_t> columns{ referenced_columns(select, table_schema) };
+    const ASTree* conditions{ select->child_of_type(ASTNodeType::CONDITIONS) };
+    const ASTree* orderby{ select->child_of_type(ASTNodeType::ORDERBY) };
+    const ASTree* projection{ select->child_at(0) };
+    const bool aggregate{ projection->child_at(0)->get_type() == ASTNodeType::AGGREGATE };
+
+    const ASTree* limit{ select->child_of_type(ASTNodeType::LIMIT) };
+    const size_t rows{ limit != nullptr ? std::stoull(limit->get_token().value) : SIZE_MAX };
+    const size_t offset{ limit != nullptr && limit->children_size() > 0 ? std::stoull(limit->child_at(0)->get_token().value) : 0 };
+
+    std::vector<std::unique_ptr<Operator>> parts;
+    size_t width{ 1 };
+    if(conditions != nullptr || aggregate){
+        parts = scan_parts<PageSize>(table_schema, table_path, access_path, columns, conditions, width);
+    }
+
+    std::unique_ptr<Operator> pipeline;
+    if(parts.empty()){
+        if(access_path.method == AccessMethod::INDEX_SCAN){
+            const Index& index{ table_schema.get_index(access_path.index)->get() };
+            pipeline = std::make_unique<IndexScan<PageSize>>(table_schema, index, table_path, index_path(table_schema, index), buffer_manager, access_path, columns);
+        }
+        else{
+            pipeline = std::make_unique<TableScan<PageSize>>(table_schema, table_path, buffer_manager, access_path, columns);
+        }
+        if(conditions != nullptr){
+            pipeline = std::make_unique<Filter>(std::move(pipeline), conditions, table_schema);
+        }
+    }
+    else if(!aggregate){
+        pipeline = std::make_unique<Gather>(std::move(parts), thread_pool, width, orderby != nullptr || limit != nullptr);
+    }
+
+    if(aggregate){
+        std::vector<AggregateCall> calls;
+        for(const auto& call : projection->get_children()){
+            const Token& argument{ call->child_at(0)->get_token() };
+            calls.push_back(AggregateCall{ aggregate_function(call->get_token().token_type),
+                argument.token_type == TokenType::ASTERISK ? "" : argument.value, call->get_token().value });
+        }
+        if(parts.empty()){
+            pipeline = std::make_unique<Aggregate>(std::move(pipeline), calls);
+        }
+        else{
+            pipeline = std::make_unique<Aggregate>(std::move(parts), calls, thread_pool, width);
+        }
+    }
+    else if(orderby != nullptr){
+        // every access path yields rows in key order, ordering by the key needs no sort,
+        // with a LIMIT the sort only has to keep the rows up to the end of the requested page
+        if(!table_schema.get_column(orderby->get_token().value)->get().is_key){
+            pipeline = std::make_unique<Sort>(std::move(pipeline), table_schema, orderby->get_token().value, sort_memory, TEMP_PATH,
+                limit != nullptr ? rows + offset : SIZE_MAX);
+        }
+    }
+    if(limit != nullptr){
+        pipeline = std::make_unique<Limit>(std::move(pipeline), rows, offset);
+    }
+    if(!aggregate){
+        std::vector<std::string> names;
+        if(projection->child_at(0)->get_token().token_type != TokenType::ASTERISK){
+            for(const auto& column : projection->get_children()){
+                names.push_back(column->get_token().value);
+            }
+        }
+        pipeline = std::make_unique<Project>(std::move(pipeline), names);
+    }
+    return pipeline;
+}
+
+// one row per line with a value for every column in declaration order, empty lines are skipped
+std::vector<char> QueryExecutor::read_rows(const std::string& path, const TableSchema& table_schema) const {
+    std::ifstream file{ path };
+    if(!file.is_open()){
+        throw std::runtime_error(std::format("Unable to open '{}'\n", path));
+    }
+    const size_t record_size{ table_schema.get_record_size() };
+    std::vector<char> records;
+    std::string line;
+    for(size_t line_number = 1; std::getline(file, line); ++line_number){
+        if(!line.empty() && line.back() == '\r') line.pop_back();
+        if(line.find_first_not_of(' ') == std::string::npos) continue;
+        try{
+            const std::vector<std::string_view> fields{ split_row(line) };
+            if(fields.size() != table_schema.columns_size()){
+                throw std::runtime_error(std::format("Expected {} values, received {}\n", table_schema.columns_size(), fields.size()));
+            }
+            for(size_t i = 0; i < fields.size(); ++i){
+                check_field(table_schema.get_column_at(i), fields[i]);
+            }
+            records.resize(records.size() + record_size);
+            buffer_manager.row_to_record(fields, table_schema, records.data() + records.size() - record_size);
+        }
+        catch(const std::runtime_error& ex){
+            throw std::runtime_error(std::format("'{}', line {}: {}", path, line_number, ex.what()));
+        }
+    }
+    return records;
 }
\ No newline at end of file
@@ -5,22 +5,36 @@
 #include "../SchemaCatalog/SchemaCatalog/SchemaCatalog.hpp"
 #include "../storage/BufferManager/BufferManager.hpp"
 #include "../storage/BTree/BTree.hpp"
+#include "../storage/SecondaryIndex/SecondaryIndex.hpp"
+#include "../storage/Sorter/Sorter.hpp"
+#include "../planner/planner.hpp"
+#include "../executor/Operator/Operator.hpp"
+#include "../executor/ResultSink/ResultSink.hpp"
+#include "../executor/ThreadPool/ThreadPool.hpp"
 #include <filesystem>
+#include <memory>
+#include <thread>
 
 class QueryExecutor {
 public:
-    QueryExecutor(SchemaCatalog&, BufferManager&, BTree&);
+    // threads is how many may scan one table at once, the executing thread included
+    QueryExecutor(SchemaCatalog&, BufferManager&, size_t sort_memory = DEFAULT_SORT_MEMORY, OutputFormat output_format = OutputFormat::TEXT,
+        size_t threads = std::thread::hardware_concurrency());
 
     void execute_script(const ASTree*);
 
 private:
     SchemaCatalog& schema_catalog;
-    BufferManager buffer_manager;
-    BTree btree;
+    BufferManager& buffer_manager;
+    Planner planner;
+    size_t sort_memory;
+    std::unique_ptr<ResultSink> result_sink; // SELECT results go to std::cout through it
+    ThreadPool thread_pool;
 
     const std::filesystem::path METADATA_PATH{ "metadata" };
     const std::filesystem::path SCHEMA_PATH =  METADATA_PATH / "schema" / "schema.db";
     const std::filesystem::path TABLES_PATH = METADATA_PATH / "tables/";
+    const std::filesystem::path TEMP_PATH = METADATA_PATH / "tmp";
 
     void execute_query(const ASTree*);
     void execute_select(const ASTree*);
@@ -29,6 +43,20 @@ private:
     void execute_update(const ASTree*);
     void execute_delete(const ASTree*);
     void execute_drop(const ASTree*);
+    void execute_copy(const ASTree*);
+    void execute_create_index(const ASTree*);
+    void execute_drop_index(const ASTree*);
+
+    std::string index_path(const TableSchema&, const Index&) const;
+    template<size_t PageSize>
+    AccessPath plan(const ASTree*, const TableSchema&);
+    template<size_t PageSize>
+    std::vector<std::unique_ptr<Operator>> scan_parts(const TableSchema&, const std::string&, const AccessPath&, const std::vector<size_t>&, const ASTree*,
+        size_t&);
+    template<size_t PageSize>
+    std::unique_ptr<Operator> build_pipeline(const ASTree*, const TableSchema&);
+
+    std::vector<char> read_rows(const std::string&, const TableSchema&) const;
 
 };
 
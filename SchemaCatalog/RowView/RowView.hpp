@@ -0,0 +1,46 @@
+#ifndef ROW_VIEW_HPP
+#define ROW_VIEW_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "../TableSchema/TableSchema.hpp"
+
+// reads the columns of a stored record by index straight out of its bytes, nothing is copied or allocated,
+// the record and the schema have to outlive the view
+class RowView {
+public:
+    RowView(const TableSchema&, const char*) noexcept;
+
+    // NUMBER columns, the key is turned back from big-endian
+    uint32_t number(size_t) const noexcept;
+    // VARCHAR columns without their '\0' padding
+    std::string_view string(size_t) const noexcept;
+
+private:
+    const std::vector<ColumnLayout>& layout;
+    const char* record;
+
+};
+
+inline RowView::RowView(const TableSchema& table_schema, const char* record) noexcept : layout{ table_schema.get_layout() }, record{ record } {}
+
+inline uint32_t RowView::number(size_t column) const noexcept {
+    uint32_t value;
+    std::memcpy(&value, record + layout[column].offset, sizeof(value));
+    if constexpr(std::endian::native == std::endian::little){
+        if(layout[column].is_key) value = std::byteswap(value);
+    }
+    return value;
+}
+
+inline std::string_view RowView::string(size_t column) const noexcept {
+    const char* value{ record + layout[column].offset };
+    return std::string_view{ value, static_cast<size_t>(std::find(value, value + layout[column].width, '\0') - value) };
+}
+
+#endif
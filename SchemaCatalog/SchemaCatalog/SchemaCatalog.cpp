@@ -22,6 +22,27 @@ void SchemaCatalog::drop_table(const std::string& table_name) noexcept {
     tables.erase(table_name);
 }
 
+void SchemaCatalog::add_index(const std::string& table_name, const Index& index){
+    tables.at(table_name).add_index(index);
+}
+
+void SchemaCatalog::drop_index(const std::string& table_name, const std::string& index_name) noexcept {
+    auto it = tables.find(table_name);
+    if(it != tables.end()){
+        it->second.drop_index(index_name);
+    }
+}
+
+// index names are unique across all tables
+std::optional<std::reference_wrapper<const TableSchema>> SchemaCatalog::get_index_table(const std::string& index_name) const noexcept {
+    for(const auto& it : tables){
+        if(it.second.get_index(index_name).has_value()){
+            return std::cref(it.second);
+        }
+    }
+    return std::nullopt;
+}
+
 void SchemaCatalog::print_tables() const {
     for(const auto& it : tables) {
         std::cout << std::format("Table: {}\n", it.first);
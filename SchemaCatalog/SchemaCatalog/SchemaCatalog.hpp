@@ -14,6 +14,9 @@ public:
     std::optional<std::reference_wrapper<const TableSchema>> get_table(const std::string&) const noexcept;
     bool table_exists(const std::string&) const noexcept;
     void drop_table(const std::string&) noexcept;
+    void add_index(const std::string&, const Index&);
+    void drop_index(const std::string&, const std::string&) noexcept;
+    std::optional<std::reference_wrapper<const TableSchema>> get_index_table(const std::string&) const noexcept;
 
     void print_tables() const;
 
@@ -3,13 +3,31 @@
 #include <iostream>
 #include <stdexcept>
 
-TableSchema::TableSchema(std::string_view name) : table_name{ name } {} 
+TableSchema::TableSchema(std::string_view name) : table_name{ name }, record_size{ 0 }, page_size{ PAGE_SIZE_ } {} 
 
 void TableSchema::add_column(const Column& col){
     for(const auto& column : columns){
         if(col.name == column.name) return;
     }
     columns.push_back(col);
+    compute_layout();
+}
+
+// records start with the key, the remaining columns follow in declaration order, the key may be declared
+// after other columns, so every offset is worked out again whenever a column is added
+void TableSchema::compute_layout() noexcept {
+    size_t offset{ 0 };
+    for(const auto& column : columns){
+        if(column.is_key) offset = column_size(column.type, true);
+    }
+    layout.clear();
+    record_size = 0;
+    for(const auto& column : columns){
+        const size_t width{ column_size(column.type, column.is_key) };
+        layout.push_back(ColumnLayout{ column.is_key ? 0 : offset, width, column.type, column.is_key });
+        if(!column.is_key) offset += width;
+        record_size += width;
+    }
 }
 
 const std::string& TableSchema::get_table_name() const noexcept {
@@ -64,6 +82,64 @@ bool TableSchema::column_exists(const std::string& col_name) const noexcept {
     return false;
 }
 
+// records start with the key, the remaining columns follow in declaration order
+size_t TableSchema::get_key_size() const {
+    const Column& key{ get_key_column() };
+    return column_size(key.type, true);
+}
+
+// where a column starts in a stored record
+size_t TableSchema::get_column_offset(const std::string& col_name) const {
+    return layout[get_column_index(col_name)].offset;
+}
+
+const std::vector<ColumnLayout>& TableSchema::get_layout() const noexcept {
+    return layout;
+}
+
+size_t TableSchema::get_record_size() const noexcept {
+    return record_size;
+}
+
+size_t TableSchema::get_page_size() const noexcept {
+    return page_size;
+}
+
+void TableSchema::set_page_size(size_t size) noexcept {
+    page_size = size;
+}
+
+void TableSchema::add_index(const Index& index){
+    indexes.push_back(index);
+}
+
+void TableSchema::drop_index(const std::string& index_name) noexcept {
+    std::erase_if(indexes, [&index_name](const Index& index){ return index.name == index_name; });
+}
+
+const std::vector<Index>& TableSchema::get_indexes() const noexcept {
+    return indexes;
+}
+
+std::optional<std::reference_wrapper<const Index>> TableSchema::get_index(const std::string& index_name) const noexcept {
+    for(const auto& index : indexes){
+        if(index.name == index_name){
+            return std::cref(index);
+        }
+    }
+    return std::nullopt;
+}
+
+// an index is stored as a table of its own, keyed by the indexed column and holding the primary key of the row
+TableSchema TableSchema::index_schema(const Index& index) const {
+    const Column& key{ get_key_column() };
+    TableSchema schema{ std::format("{}.{}", table_name, index.name) };
+    schema.add_column(Column{ index.column, get_column(index.column)->get().type, true });
+    schema.add_column(Column{ key.name, key.type, false });
+    schema.set_page_size(page_size);
+    return schema;
+}
+
 void TableSchema::print_column_names() const {
     for(const auto& col : columns){
         std::cout << std::format("Column name: {}, type: {}, key: {}\n", col.name, data_type_str.at(col.type), col.is_key ? "True" : "False");
@@ -6,6 +6,7 @@
 #include <optional>
 
 #include "../defs/schemadefs.hpp"
+#include "../../storage/storage/page.hpp"
 
 class TableSchema{
 public:
@@ -23,11 +24,31 @@ public:
     size_t get_column_index(const std::string&) const;
     bool column_exists(const std::string&) const noexcept;
 
+    size_t get_key_size() const;
+    size_t get_column_offset(const std::string&) const;
+    // one entry per column in declaration order
+    const std::vector<ColumnLayout>& get_layout() const noexcept;
+    size_t get_record_size() const noexcept;
+    size_t get_page_size() const noexcept;
+    void set_page_size(size_t) noexcept;
+
+    void add_index(const Index&);
+    void drop_index(const std::string&) noexcept;
+    const std::vector<Index>& get_indexes() const noexcept;
+    std::optional<std::reference_wrapper<const Index>> get_index(const std::string&) const noexcept;
+    TableSchema index_schema(const Index&) const;
+
     void print_column_names() const;
 
 private:
     std::string table_name;
     std::vector<Column> columns;
+    std::vector<ColumnLayout> layout;
+    size_t record_size;
+    size_t page_size;
+    std::vector<Index> indexes;
+
+    void compute_layout() noexcept;
 
 };
 
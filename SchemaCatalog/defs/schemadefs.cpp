@@ -1,6 +1,8 @@
 #include "schemadefs.hpp"
 #include <string_view>
 
+#include "../../storage/storage/page.hpp"
+
 const std::unordered_map<DataType, std::string> data_type_str {
     {DataType::NUMBER, "NUMBER"},
     {DataType::VARCHAR, "VARCHAR"}
@@ -13,4 +15,11 @@ const std::unordered_map<TokenType, DataType> literal_to_type {
     {TokenType::NUMBER, DataType::NUMBER}
 };
 
-Column::Column(std::string_view name, DataType type, bool is_key) : name{ name }, type { type }, is_key{ is_key } {}
\ No newline at end of file
+Column::Column(std::string_view name, DataType type, bool is_key) : name{ name }, type { type }, is_key{ is_key } {}
+
+size_t column_size(DataType type, bool is_key) noexcept {
+    if(type == DataType::NUMBER){
+        return sizeof(uint32_t);
+    }
+    return is_key ? MAX_KEY_SIZE : MAX_STRING_LEN;
+}
\ No newline at end of file
@@ -21,4 +21,21 @@ struct Column {
     Column(std::string_view, DataType, bool);
 };
 
+// secondary index over one non-key column
+struct Index {
+    std::string name;
+    std::string column;
+};
+
+// where a column sits in a stored record and how it is encoded there
+struct ColumnLayout {
+    size_t offset;
+    size_t width;
+    DataType type;
+    bool is_key;
+};
+
+// bytes a column takes in a stored record
+size_t column_size(DataType, bool is_key) noexcept;
+
 #endif
\ No newline at end of file
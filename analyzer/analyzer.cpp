@@ -1,6 +1,7 @@
 #include "analyzer.hpp"
 
 #include <cstdint>
+#include <filesystem>
 #include <format>
 #include <memory>
 #include <optional>
@@ -38,6 +39,9 @@ void Analyzer::analyze_query(const ASTree* query) const {
         case TokenType::DROP:
             analyze_drop(query);
             break;
+        case TokenType::COPY:
+            analyze_copy(query);
+            break;
         default:
             throw std::runtime_error(std::format("Invalid query command: '{}'\n", token_type_str.at(query->get_token().token_type)));
     }
@@ -51,22 +55,35 @@ void Analyzer::analyze_select(const ASTree* select) const {
     analyze_columns(table_schema, select->child_at(0));
     duplicate_columns(select->child_at(0));
 
-    if(select->children_size() >= 3 && select->child_at(2)->get_type() == ASTNodeType::CONDITIONS){
-        analyze_conditions(table_schema, select->child_at(2));
+    if(const ASTree* conditions = select->child_of_type(ASTNodeType::CONDITIONS)){
+        analyze_conditions(table_schema, conditions);
     }
 
-    if(select->get_children().back()->get_type() == ASTNodeType::ORDERBY){
-        analyze_orderby(table_schema, select->get_children().back().get());
+    if(const ASTree* orderby = select->child_of_type(ASTNodeType::ORDERBY)){
+        analyze_orderby(table_schema, orderby);
+    }
+    if(const ASTree* limit = select->child_of_type(ASTNodeType::LIMIT)){
+        analyze_row_count(limit);
+        if(limit->children_size() > 0){
+            analyze_row_count(limit->child_at(0));
+        }
     }
 }
 
 void Analyzer::analyze_create(const ASTree* create) const {
+    if(create->child_at(0)->get_type() == ASTNodeType::INDEX){
+        analyze_create_index(create);
+        return;
+    }
     const std::string& table_name{ create->child_at(0)->get_token().value };
     analyze_table(table_name, false);
     duplicate_columns(create->child_at(1));
     analyze_keys(create->child_at(1));
     analyze_column_name(create->child_at(1));
     analyze_required_memory(create->child_at(1));
+    if(create->children_size() > 2){
+        analyze_page_size(create->child_at(2));
+    }
 }
 
 void Analyzer::analyze_insert(const ASTree* insert) const {
@@ -77,10 +94,12 @@ void Analyzer::analyze_insert(const ASTree* insert) const {
     analyze_columns(table_schema, insert->child_at(1));
     duplicate_columns(insert->child_at(1));
 
-    if(insert->child_at(1)->children_size() != insert->child_at(2)->children_size()){
-        throw std::runtime_error("Number of provided values doesn't match the number of provided columns\n");
+    for(size_t i = 2; i < insert->children_size(); ++i){
+        if(insert->child_at(1)->children_size() != insert->child_at(i)->children_size()){
+            throw std::runtime_error("Number of provided values doesn't match the number of provided columns\n");
+        }
+        analyze_insert_types(table_schema, insert->child_at(1), insert->child_at(i));
     }
-    analyze_insert_types(table_schema, insert->child_at(1), insert->child_at(2));
 }
 
 void Analyzer::analyze_insert_types(const TableSchema& table_schema, const ASTree* columns, const ASTree* values) const {
@@ -127,25 +146,71 @@ void Analyzer::analyze_delete(const ASTree* _delete) const {
 }
 
 void Analyzer::analyze_drop(const ASTree* drop) const {
+    if(drop->child_at(0)->get_type() == ASTNodeType::INDEX){
+        analyze_index(drop->child_at(0)->get_token().value);
+        return;
+    }
     const std::string& table_name{ drop->child_at(0)->get_token().value };
     analyze_table(table_name);
 }
 
+void Analyzer::analyze_create_index(const ASTree* create) const {
+    analyze_index(create->child_at(0)->get_token().value, false);
+    const std::string& table_name{ create->child_at(1)->get_token().value };
+    analyze_table(table_name);
+
+    const TableSchema& table_schema{ schema_catalog.get_table(table_name)->get() };
+    const std::string& column_name{ create->child_at(2)->get_token().value };
+    analyze_column(table_schema, create->child_at(2));
+    if(table_schema.get_column(column_name)->get().is_key){
+        throw std::runtime_error(std::format("Column '{}' is the primary key and already indexed\n", column_name));
+    }
+    if(table_schema.get_indexes().size() >= MAX_INDEXES){
+        throw std::runtime_error(std::format("Table '{}' already has the maximum of {} indexes\n", table_name, MAX_INDEXES));
+    }
+}
+
+void Analyzer::analyze_copy(const ASTree* copy) const {
+    const std::string& table_name{ copy->child_at(0)->get_token().value };
+    analyze_table(table_name);
+
+    const std::string& source{ copy->child_at(1)->get_token().value };
+    if(!std::filesystem::is_regular_file(source)){
+        throw std::runtime_error(std::format("File '{}' doesn't exist\n", source));
+    }
+    if(copy->children_size() > 2){
+        analyze_fill_factor(copy->child_at(2));
+    }
+}
+
 void Analyzer::analyze_conditions(const TableSchema& table_schema, const ASTree* conditions) const {
-    const ASTree* condition{ conditions->child_at(0) };
-    const DataType& left{ condition->child_at(0)->get_type() == ASTNodeType::ID ? 
-            table_schema.get_column(condition->child_at(0)->get_token().value)->get().type : 
-                literal_to_type.at(condition->child_at(0)->get_token().token_type) };
-    
-    const DataType& right{ condition->child_at(1)->get_type() == ASTNodeType::ID ? 
-            table_schema.get_column(condition->child_at(1)->get_token().value)->get().type : 
-                literal_to_type.at(condition->child_at(1)->get_token().token_type) };
+    analyze_condition(table_schema, conditions->child_at(0));
+}
+
+void Analyzer::analyze_condition(const TableSchema& table_schema, const ASTree* condition) const {
+    const TokenType connective{ condition->get_token().token_type };
+    if(connective == TokenType::AND || connective == TokenType::OR){
+        analyze_condition(table_schema, condition->child_at(0));
+        analyze_condition(table_schema, condition->child_at(1));
+        return;
+    }
 
+    const DataType left{ operand_type(table_schema, condition->child_at(0)) };
+    const DataType right{ operand_type(table_schema, condition->child_at(1)) };
     if(left != right){
         throw std::runtime_error(std::format("Type mismatch: left op - '{}', right op - '{}'\n", data_type_str.at(left), data_type_str.at(right)));
     }
 }
 
+DataType Analyzer::operand_type(const TableSchema& table_schema, const ASTree* operand) const {
+    if(operand->get_type() == ASTNodeType::ID){
+        analyze_column(table_schema, operand);
+        return table_schema.get_column(operand->get_token().value)->get().type;
+    }
+    analyze_value(operand);
+    return literal_to_type.at(operand->get_token().token_type);
+}
+
 void Analyzer::analyze_orderby(const TableSchema& table_schema, const ASTree* orderby) const {
     analyze_column(table_schema, orderby);
 }
@@ -160,6 +225,16 @@ void Analyzer::analyze_table(const std::string& table_name, bool should_exist) c
     }
 }
 
+void Analyzer::analyze_index(const std::string& index_name, bool should_exist) const {
+    if(index_name.length() >= MAX_COLUMN_LEN) {
+        throw std::runtime_error(std::format("Maximum length for an index's name is {}, received {}\n", MAX_COLUMN_LEN - 1, index_name.length()));
+    }
+    bool exists{ schema_catalog.get_index_table(index_name) != std::nullopt };
+    if(exists != should_exist){
+        throw std::runtime_error(std::format("Index '{}' {}\n", index_name, should_exist ? "doesn't exist" : "already exists"));
+    }
+}
+
 void Analyzer::analyze_assignments(const TableSchema& table_schema, const ASTree* assignments) const {
     analyze_columns(table_schema, assignments);
     analyze_assignment_type(table_schema, assignments);
@@ -182,8 +257,35 @@ void Analyzer::analyze_columns(const TableSchema& table_schema, const ASTree* co
     if(columns->child_at(0)->get_token().token_type == TokenType::ASTERISK){
         return;
     }
+    bool aggregates{ false };
+    bool plain{ false };
     for(const auto& column : columns->get_children()){
-        analyze_column(table_schema, column.get());
+        if(column->get_type() == ASTNodeType::AGGREGATE){
+            analyze_aggregate(table_schema, column.get());
+            aggregates = true;
+        }
+        else{
+            analyze_column(table_schema, column.get());
+            plain = true;
+        }
+    }
+    // there is no GROUP BY, an aggregate folds the whole table into one row
+    if(aggregates && plain){
+        throw std::runtime_error("Columns can't be selected together with aggregates\n");
+    }
+}
+
+void Analyzer::analyze_aggregate(const TableSchema& table_schema, const ASTree* aggregate) const {
+    const ASTree* argument{ aggregate->child_at(0) };
+    if(argument->get_token().token_type == TokenType::ASTERISK){
+        if(aggregate->get_token().token_type != TokenType::COUNT){
+            throw std::runtime_error(std::format("'{}' requires a column\n", aggregate->get_token().value));
+        }
+        return;
+    }
+    analyze_column(table_schema, argument);
+    if(aggregate->get_token().token_type == TokenType::SUM && table_schema.get_column(argument->get_token().value)->get().type != DataType::NUMBER){
+        throw std::runtime_error(std::format("'{}' requires a NUMBER column\n", aggregate->get_token().value));
     }
 }
 
@@ -245,18 +347,30 @@ void Analyzer::analyze_value(const ASTree* value) const {
 void Analyzer::analyze_required_memory(const ASTree* columns) const {
     size_t required_memory{ 0 };
     for(const auto& column : columns->get_children()){
-        if(column->children_size() > 1){
-            required_memory += MAX_KEY_SIZE + sizeof(DataType);
-        }
-        else if(column->child_at(0)->get_token().token_type == TokenType::VARCHAR){
-            required_memory += MAX_STRING_LEN + sizeof(DataType);
-        }
-        else{
-            required_memory += sizeof(uint32_t) + sizeof(DataType);
-        }
+        required_memory += column_size(literal_to_type.at(column->child_at(0)->get_token().token_type), column->children_size() > 1);
+    }
+    if(required_memory > MAX_RECORD_SIZE) {
+        throw std::runtime_error(std::format("Maximum row size is {}B, requested {}B\n", MAX_RECORD_SIZE, required_memory));
+    }
+}
+
+void Analyzer::analyze_page_size(const ASTree* page_size) const {
+    const std::string& value{ page_size->get_token().value };
+    if(value.size() > 5 || !is_supported_page_size(std::stoul(value))){
+        throw std::runtime_error(std::format("Unsupported page size '{}', expected 4096, 8192, 16384 or 65536\n", value));
     }
-    required_memory += sizeof(uint8_t); // is_deleted
-    if(required_memory > BLOCK_SIZE_) {
-        throw std::runtime_error(std::format("Maximum block size is {}B, requested {}B\n", BLOCK_SIZE_, required_memory));
+}
+
+void Analyzer::analyze_row_count(const ASTree* row_count) const {
+    const std::string& value{ row_count->get_token().value };
+    if(value.size() > 18){
+        throw std::runtime_error(std::format("{} must be below 10^18, received '{}'\n", ast_node_str.at(row_count->get_type()), value));
+    }
+}
+
+void Analyzer::analyze_fill_factor(const ASTree* fill_factor) const {
+    const std::string& value{ fill_factor->get_token().value };
+    if(value.size() > 3 || std::stoul(value) < MIN_FILL_FACTOR || std::stoul(value) > MAX_FILL_FACTOR){
+        throw std::runtime_error(std::format("Fill factor must be between {} and {}, received '{}'\n", MIN_FILL_FACTOR, MAX_FILL_FACTOR, value));
     }
 }
\ No newline at end of file
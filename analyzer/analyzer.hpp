@@ -20,21 +20,30 @@ private:
     void analyze_update(const ASTree*) const;
     void analyze_delete(const ASTree*) const;
     void analyze_drop(const ASTree*) const;
+    void analyze_copy(const ASTree*) const;
+    void analyze_create_index(const ASTree*) const;
     void analyze_conditions(const TableSchema&, const ASTree*) const;
+    void analyze_condition(const TableSchema&, const ASTree*) const;
+    DataType operand_type(const TableSchema&, const ASTree*) const;
     void analyze_orderby(const TableSchema&, const ASTree*) const;
 
     void analyze_table(const std::string&, bool should_exist = true) const;
+    void analyze_index(const std::string&, bool should_exist = true) const;
     void analyze_assignments(const TableSchema&, const ASTree*) const;
     void analyze_assignment_type(const TableSchema&, const ASTree*) const;
 
     void analyze_columns(const TableSchema&, const ASTree*) const;
     void analyze_column(const TableSchema&, const ASTree*) const;
+    void analyze_aggregate(const TableSchema&, const ASTree*) const;
     void duplicate_columns(const ASTree*) const;
     void analyze_insert_types(const TableSchema&, const ASTree*, const ASTree*) const;
     void analyze_keys(const ASTree*) const;
     void analyze_column_name(const ASTree*) const;
     void analyze_value(const ASTree*) const;
     void analyze_required_memory(const ASTree* columns) const;
+    void analyze_page_size(const ASTree*) const;
+    void analyze_fill_factor(const ASTree*) const;
+    void analyze_row_count(const ASTree*) const;
 
 };
 
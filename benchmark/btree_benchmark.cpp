@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../storage/BTree/BTree.hpp"
+#include "../storage/BufferManager/BufferManager.hpp"
+
+// builds one table per supported page size and reports tree height and point lookup latency,
+// warm runs reuse the pool the table was built with, cold runs start from an empty pool
+namespace {
+
+constexpr size_t DEFAULT_ROWS = 200000;
+constexpr size_t LOOKUPS = 20000;
+const std::filesystem::path BENCH_PATH{ "benchmark_tables" };
+
+std::string key_at(size_t i) {
+    return std::format("key{:010}", i);
+}
+
+// (PRIMARY KEY VARCHAR k, NUMBER v)
+TableSchema bench_schema() {
+    TableSchema table_schema{ "bench" };
+    table_schema.add_column(Column{ "k", DataType::VARCHAR, true });
+    table_schema.add_column(Column{ "v", DataType::NUMBER, false });
+    return table_schema;
+}
+
+std::vector<char> record_at(size_t i, const TableSchema& table_schema) {
+    std::vector<char> record(table_schema.get_record_size());
+    const std::string key{ key_at(i) };
+    const uint32_t value{ static_cast<uint32_t>(i) };
+    std::memcpy(record.data(), key.data(), key.size());
+    std::memcpy(record.data() + table_schema.get_key_size(), &value, sizeof(value));
+    return record;
+}
+
+template<size_t PageSize>
+double lookup_latency(BTree<PageSize>& btree, BufferManager& buffer_manager, const std::string& table_path, const std::vector<size_t>& probes) {
+    size_t found{ 0 };
+    auto start = std::chrono::steady_clock::now();
+    for(size_t probe : probes){
+        std::string key{ key_at(probe) };
+        key.resize(MAX_KEY_SIZE);
+        found += btree.search(key.data(), table_path, buffer_manager).has_value();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if(found != probes.size()){
+        throw std::runtime_error(std::format("Lookup missed {} keys\n", probes.size() - found));
+    }
+    return elapsed / static_cast<double>(probes.size());
+}
+
+template<size_t PageSize>
+void run(size_t rows) {
+    const std::string table_path{ (BENCH_PATH / std::format("t{}.db", PageSize)).generic_string() };
+    const TableSchema table_schema{ bench_schema() };
+    BTree<PageSize> btree{ table_schema };
+
+    std::vector<size_t> order(rows);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937 rng{ 42 };
+    std::shuffle(order.begin(), order.end(), rng);
+
+    std::vector<size_t> probes(LOOKUPS);
+    for(auto& probe : probes){
+        probe = order[rng() % rows];
+    }
+
+    double warm{ 0 };
+    double build{ 0 };
+    size_t height{ 0 };
+    {
+        BufferManager buffer_manager{};
+        buffer_manager.init_table(table_path, PageSize);
+        auto start = std::chrono::steady_clock::now();
+        for(size_t i : order){
+            btree.insert(record_at(i, table_schema), buffer_manager, table_path);
+        }
+        build = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        height = btree.height(table_path, buffer_manager);
+        lookup_latency(btree, buffer_manager, table_path, probes);
+        warm = lookup_latency(btree, buffer_manager, table_path, probes);
+    }
+
+    BufferManager buffer_manager{};
+    const double cold{ lookup_latency(btree, buffer_manager, table_path, probes) };
+
+    const size_t rows_per_leaf{ TablePage<PageSize>::DATA_SIZE / (table_schema.get_record_size() + sizeof(Slot)) };
+    const size_t fanout{ TablePage<PageSize>::capacity(table_schema.get_key_size()) + 1 };
+    std::cout << std::format("{:>9} {:>6} {:>7} {:>7} {:>10.2f} {:>12.0f} {:>12.0f} {:>10}\n", PageSize, rows_per_leaf, fanout, height,
+        build, warm, cold, std::filesystem::file_size(table_path) / 1024);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const size_t rows{ argc > 1 ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_ROWS };
+    std::filesystem::create_directories(BENCH_PATH);
+
+    std::cout << std::format("{} rows, {} random lookups\n", rows, LOOKUPS);
+    std::cout << std::format("{:>9} {:>6} {:>7} {:>7} {:>10} {:>12} {:>12} {:>10}\n", "page", "rows", "fanout", "height", "build s", "warm ns/op", "cold ns/op", "file KiB");
+    for(size_t page_size : { 4096, 8192, 16384, 65536 }){
+        with_page_size(page_size, [rows](auto size){ run<decltype(size)::value>(rows); });
+    }
+    std::filesystem::remove_all(BENCH_PATH);
+    return 0;
+}
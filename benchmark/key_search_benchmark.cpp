@@ -0,0 +1,67 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../storage/KeySearch/KeySearch.hpp"
+#include "../storage/storage/page.hpp"
+
+// searches one full internal page worth of sorted key prefixes per page size and key width
+// with every search kind the build and CPU support
+namespace {
+
+constexpr size_t SEARCHES = 2000000;
+
+volatile size_t sink; // keeps the searches from being optimized away
+
+template<size_t PageSize>
+void run(size_t key_size, const std::string& key_type) {
+    const size_t n{ TablePage<PageSize>::capacity(key_size) };
+    std::mt19937 rng{ 42 };
+    std::vector<int32_t> keys(n);
+    int32_t key{ INT32_MIN };
+    for(auto& k : keys){
+        key += static_cast<int32_t>(rng() % 1000 + 1);
+        k = key;
+    }
+    std::vector<int32_t> probes(4096);
+    for(auto& probe : probes){
+        probe = static_cast<int32_t>(INT32_MIN + static_cast<int64_t>(rng() % (static_cast<uint64_t>(key - INT32_MIN) + 1)));
+    }
+
+    std::string line{ std::format("{:>9} {:>8} {:>6}", PageSize, key_type, n) };
+    for(KeySearchKind kind : { KeySearchKind::SCALAR, KeySearchKind::BINARY, KeySearchKind::SSE2, KeySearchKind::AVX2 }){
+        const CountLess search{ count_less_for(kind) };
+        if(search == nullptr){
+            line += std::format(" {:>10}", "-");
+            continue;
+        }
+        size_t checksum{ 0 };
+        auto start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < SEARCHES; ++i){
+            checksum += search(keys.data(), n, probes[i % probes.size()]);
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        sink = checksum;
+        line += std::format(" {:>10.1f}", elapsed / static_cast<double>(SEARCHES));
+    }
+    std::cout << line << '\n';
+}
+
+}
+
+int main() {
+    std::cout << std::format("{} searches per node, ns/search\n", SEARCHES);
+    std::cout << std::format("{:>9} {:>8} {:>6} {:>10} {:>10} {:>10} {:>10}\n", "page", "key", "keys", "scalar", "binary", "sse2", "avx2");
+    for(size_t page_size : { 4096, 8192, 16384, 65536 }){
+        with_page_size(page_size, [](auto size){
+            run<decltype(size)::value>(sizeof(uint32_t), "NUMBER");
+            run<decltype(size)::value>(MAX_KEY_SIZE, "VARCHAR");
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include "Aggregate.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+namespace {
+
+bool is_extreme(AggregateFunction function) noexcept {
+    return function == AggregateFunction::MIN || function == AggregateFunction::MAX;
+}
+
+FieldType result_type(AggregateFunction function, const Field& argument) noexcept {
+    if(!is_extreme(function)) return FieldType::COUNT;
+    return argument.type;
+}
+
+std::vector<Field> call_arguments(const std::vector<Field>& available, const std::vector<AggregateCall>& calls) {
+    std::vector<Field> arguments;
+    for(const auto& call : calls){
+        Field argument{ "", FieldType::NONE, 0 };
+        if(!call.column.empty()){
+            auto field = std::find_if(available.begin(), available.end(), [&call](const Field& field){ return field.name == call.column; });
+            if(field == available.end()){
+                throw std::runtime_error(std::format("Unknown column '{}'\n", call.column));
+            }
+            argument = *field;
+        }
+        arguments.push_back(argument);
+    }
+    return arguments;
+}
+
+std::vector<FieldType> result_types(const std::vector<AggregateCall>& calls, const std::vector<Field>& arguments) {
+    std::vector<FieldType> types;
+    for(size_t i = 0; i < calls.size(); ++i){
+        types.push_back(result_type(calls[i].function, arguments[i]));
+    }
+    return types;
+}
+
+std::vector<std::unique_ptr<Operator>> single(std::unique_ptr<Operator> input) {
+    std::vector<std::unique_ptr<Operator>> inputs;
+    inputs.push_back(std::move(input));
+    return inputs;
+}
+
+}
+
+Aggregate::Aggregate(std::unique_ptr<Operator> input, const std::vector<AggregateCall>& calls) : Aggregate{ single(std::move(input)), calls, nullptr, 1 } {}
+
+Aggregate::Aggregate(std::vector<std::unique_ptr<Operator>> inputs, const std::vector<AggregateCall>& calls, ThreadPool& pool, size_t width) :
+    Aggregate{ std::move(inputs), calls, &pool, width } {}
+
+// the result batch holds a single row, column i is the value of call i
+Aggregate::Aggregate(std::vector<std::unique_ptr<Operator>> inputs, const std::vector<AggregateCall>& calls, ThreadPool* pool, size_t width) :
+    inputs{ std::move(inputs) }, calls{ calls }, arguments{ call_arguments(this->inputs.front()->get_fields(), calls) }, pool{ pool }, width{ width },
+    result{ result_types(calls, arguments) }, done{ true } {
+    for(size_t i = 0; i < calls.size(); ++i){
+        fields.push_back(Field{ calls[i].name, result_type(calls[i].function, arguments[i]), i });
+    }
+}
+
+// every input is folded into a partial row of its own, the partials of inputs that had rows are combined in order
+void Aggregate::open() {
+    std::vector<RowBatch> partials(inputs.size(), result);
+    std::vector<uint8_t> filled(inputs.size(), 0);
+    auto fold_input = [&](size_t i){
+        inputs[i]->open();
+        filled[i] = fold(*inputs[i], partials[i]);
+    };
+    if(pool != nullptr && inputs.size() > 1){
+        pool->run(inputs.size(), width, fold_input);
+    }
+    else{
+        for(size_t i = 0; i < inputs.size(); ++i){
+            fold_input(i);
+        }
+    }
+
+    result.clear();
+    result.size = 1;
+    for(auto& column : result.columns){
+        std::fill(column.counts.begin(), column.counts.end(), 0);
+    }
+    bool first{ true };
+    for(size_t p = 0; p < partials.size(); ++p){
+        if(!filled[p]) continue;
+        for(size_t i = 0; i < calls.size(); ++i){
+            combine(i, partials[p], first);
+        }
+        first = false;
+    }
+    for(size_t i = 0; i < calls.size(); ++i){
+        fields[i].type = first && is_extreme(calls[i].function) ? FieldType::NONE : result_type(calls[i].function, arguments[i]);
+    }
+    result.select_all();
+    done = false;
+}
+
+RowBatch* Aggregate::next() {
+    if(done) return nullptr;
+    done = true;
+    return &result;
+}
+
+// false when the input had no rows
+bool Aggregate::fold(Operator& input, RowBatch& partial) const {
+    for(auto& column : partial.columns){
+        std::fill(column.counts.begin(), column.counts.end(), 0);
+    }
+    bool first{ true };
+    for(RowBatch* batch = input.next(); batch != nullptr; batch = input.next()){
+        for(size_t i = 0; i < calls.size(); ++i){
+            accumulate(partial, i, *batch, first);
+        }
+        first = false;
+    }
+    return !first;
+}
+
+// the first batch seeds MIN and MAX with its first selected row, strings are padded with '\0',
+// so comparing every byte orders them the way their text does
+void Aggregate::accumulate(RowBatch& partial, size_t i, const RowBatch& batch, bool first) const {
+    const std::vector<uint16_t>& selection{ batch.selection };
+    ColumnVector& value{ partial.columns[i] };
+    switch(calls[i].function){
+        case AggregateFunction::COUNT:
+            value.counts[0] += selection.size();
+            break;
+        case AggregateFunction::SUM: {
+            const uint32_t* numbers{ batch.columns[arguments[i].column].numbers.data() };
+            uint64_t total{ 0 };
+            for(uint16_t row : selection){
+                total += numbers[row];
+            }
+            value.counts[0] += total;
+            break;
+        }
+        case AggregateFunction::MIN:
+        case AggregateFunction::MAX: {
+            const bool min{ calls[i].function == AggregateFunction::MIN };
+            if(arguments[i].type == FieldType::VARCHAR){
+                const char* strings{ batch.columns[arguments[i].column].strings.data() };
+                char* extreme{ value.strings.data() };
+                if(first){
+                    std::memcpy(extreme, strings + selection.front() * MAX_STRING_LEN, MAX_STRING_LEN);
+                }
+                for(uint16_t row : selection){
+                    const int order{ std::memcmp(strings + row * MAX_STRING_LEN, extreme, MAX_STRING_LEN) };
+                    if(min ? order < 0 : order > 0){
+                        std::memcpy(extreme, strings + row * MAX_STRING_LEN, MAX_STRING_LEN);
+                    }
+                }
+                break;
+            }
+            const uint32_t* numbers{ batch.columns[arguments[i].column].numbers.data() };
+            uint32_t extreme{ first ? numbers[selection.front()] : value.numbers[0] };
+            for(uint16_t row : selection){
+                extreme = min ? std::min(extreme, numbers[row]) : std::max(extreme, numbers[row]);
+            }
+            value.numbers[0] = extreme;
+            break;
+        }
+    }
+}
+
+// COUNT and SUM add up, MIN and MAX keep the extreme of the partials, the first one seeds them
+void Aggregate::combine(size_t i, const RowBatch& partial, bool first) {
+    const ColumnVector& part{ partial.columns[i] };
+    ColumnVector& value{ result.columns[i] };
+    if(!is_extreme(calls[i].function)){
+        value.counts[0] += part.counts[0];
+        return;
+    }
+    const bool min{ calls[i].function == AggregateFunction::MIN };
+    if(arguments[i].type == FieldType::VARCHAR){
+        const int order{ std::memcmp(part.strings.data(), value.strings.data(), MAX_STRING_LEN) };
+        if(first || (min ? order < 0 : order > 0)){
+            std::memcpy(value.strings.data(), part.strings.data(), MAX_STRING_LEN);
+        }
+        return;
+    }
+    if(first || (min ? part.numbers[0] < value.numbers[0] : part.numbers[0] > value.numbers[0])){
+        value.numbers[0] = part.numbers[0];
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef AGGREGATE_HPP
+#define AGGREGATE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Operator/Operator.hpp"
+#include "../ThreadPool/ThreadPool.hpp"
+
+enum class AggregateFunction : uint8_t { COUNT, SUM, MIN, MAX };
+
+// column is empty for COUNT(*), name is what the result column is called
+struct AggregateCall {
+    AggregateFunction function;
+    std::string column;
+    std::string name;
+};
+
+// folds every row of its input into a single row with one value per call, COUNT and SUM are 64-bit,
+// MIN and MAX keep the type of their column and are NULL when there are no input rows,
+// several inputs with the same fields are folded on the pool side by side and their partial rows combined
+class Aggregate : public Operator {
+public:
+    Aggregate(std::unique_ptr<Operator>, const std::vector<AggregateCall>&);
+    // at most width threads fold inputs at once, the caller included
+    Aggregate(std::vector<std::unique_ptr<Operator>>, const std::vector<AggregateCall>&, ThreadPool&, size_t);
+
+    void open() override;
+    RowBatch* next() override;
+
+private:
+    std::vector<std::unique_ptr<Operator>> inputs;
+    std::vector<AggregateCall> calls;
+    std::vector<Field> arguments; // input field of each call
+    ThreadPool* pool;
+    size_t width;
+    RowBatch result;
+    bool done;
+
+    Aggregate(std::vector<std::unique_ptr<Operator>>, const std::vector<AggregateCall>&, ThreadPool*, size_t);
+
+    bool fold(Operator&, RowBatch&) const;
+    void accumulate(RowBatch&, size_t, const RowBatch&, bool) const;
+    void combine(size_t, const RowBatch&, bool);
+
+};
+
+#endif
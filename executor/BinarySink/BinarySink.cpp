@@ -0,0 +1,61 @@
+#include "BinarySink.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace {
+
+constexpr char ROW_MARK = 1;
+constexpr char END_MARK = 0;
+
+}
+
+BinarySink::BinarySink(std::ostream& out) : ResultSink{ out } {}
+
+void BinarySink::begin(const std::vector<Field>& fields) {
+    append_integer(static_cast<uint16_t>(fields.size()));
+    for(const auto& field : fields){
+        append_integer(static_cast<uint8_t>(field.type));
+        append_integer(static_cast<uint8_t>(field.name.size()));
+        append(field.name);
+    }
+}
+
+void BinarySink::row(const RowBatch& batch, size_t row, const std::vector<Field>& fields) {
+    append(ROW_MARK);
+    for(const auto& field : fields){
+        switch(field.type){
+            case FieldType::NUMBER:
+                append_integer(static_cast<uint8_t>(sizeof(uint32_t)));
+                append_integer(batch.columns[field.column].numbers[row]);
+                break;
+            case FieldType::COUNT:
+                append_integer(static_cast<uint8_t>(sizeof(uint64_t)));
+                append_integer(batch.columns[field.column].counts[row]);
+                break;
+            case FieldType::VARCHAR: {
+                std::string_view value{ batch.string_at(field.column, row) };
+                append_integer(static_cast<uint8_t>(value.size()));
+                append(value);
+                break;
+            }
+            case FieldType::NONE:
+                append_integer(uint8_t{ 0 });
+                break;
+        }
+    }
+}
+
+void BinarySink::end(size_t rows) {
+    append(END_MARK);
+    append_integer(static_cast<uint64_t>(rows));
+}
+
+template<typename T>
+void BinarySink::append_integer(T value) {
+    if constexpr(std::endian::native == std::endian::little && sizeof(T) > 1){
+        value = std::byteswap(value);
+    }
+    std::memcpy(reserve(sizeof(value)), &value, sizeof(value));
+    commit(sizeof(value));
+}
@@ -0,0 +1,25 @@
+#ifndef BINARY_SINK_HPP
+#define BINARY_SINK_HPP
+
+#include "../ResultSink/ResultSink.hpp"
+
+// integers are big-endian, a result is
+//   u16 column count, per column: u8 FieldType, u8 name length, name
+//   per row: u8 1, per value: u8 length, bytes (NUMBER 4, COUNT 8, VARCHAR its characters, NULL none)
+//   u8 0, u64 row count
+class BinarySink : public ResultSink {
+public:
+    explicit BinarySink(std::ostream&);
+
+protected:
+    void begin(const std::vector<Field>&) override;
+    void row(const RowBatch&, size_t, const std::vector<Field>&) override;
+    void end(size_t) override;
+
+private:
+    template<typename T>
+    void append_integer(T);
+
+};
+
+#endif
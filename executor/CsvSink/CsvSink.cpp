@@ -0,0 +1,47 @@
+#include "CsvSink.hpp"
+
+CsvSink::CsvSink(std::ostream& out) : ResultSink{ out } {}
+
+void CsvSink::begin(const std::vector<Field>& fields) {
+    for(size_t i = 0; i < fields.size(); ++i){
+        if(i > 0) append(',');
+        append(fields[i].name);
+    }
+    append('\n');
+}
+
+// NULL is written bare, a string reading NULL is quoted
+void CsvSink::row(const RowBatch& batch, size_t row, const std::vector<Field>& fields) {
+    for(size_t i = 0; i < fields.size(); ++i){
+        if(i > 0) append(',');
+        const Field& field = fields[i];
+        switch(field.type){
+            case FieldType::NUMBER:
+                append_number(batch.columns[field.column].numbers[row]);
+                break;
+            case FieldType::COUNT:
+                append_number(batch.columns[field.column].counts[row]);
+                break;
+            case FieldType::VARCHAR:
+                append_string(batch.string_at(field.column, row));
+                break;
+            case FieldType::NONE:
+                append("NULL");
+                break;
+        }
+    }
+    append('\n');
+}
+
+void CsvSink::end(size_t) {
+    append('\n');
+}
+
+// COPY splits on commas and trims spaces around unquoted values
+void CsvSink::append_string(std::string_view value) {
+    const bool quoted{ value.find(',') != std::string_view::npos || value == "NULL" ||
+        (!value.empty() && (value.front() == ' ' || value.back() == ' ' || value.front() == '\'')) };
+    if(quoted) append('\'');
+    append(value);
+    if(quoted) append('\'');
+}
@@ -0,0 +1,22 @@
+#ifndef CSV_SINK_HPP
+#define CSV_SINK_HPP
+
+#include "../ResultSink/ResultSink.hpp"
+
+// a header line with the column names, then one line per row, an empty line ends the result,
+// values are quoted the way COPY reads them so the rows load back as they are
+class CsvSink : public ResultSink {
+public:
+    explicit CsvSink(std::ostream&);
+
+protected:
+    void begin(const std::vector<Field>&) override;
+    void row(const RowBatch&, size_t, const std::vector<Field>&) override;
+    void end(size_t) override;
+
+private:
+    void append_string(std::string_view);
+
+};
+
+#endif
@@ -0,0 +1,19 @@
+#include "Filter.hpp"
+
+Filter::Filter(std::unique_ptr<Operator> input, const ASTree* conditions, const TableSchema& table_schema) :
+    input{ std::move(input) }, predicate{ conditions, table_schema } {
+    fields = this->input->get_fields();
+}
+
+void Filter::open() {
+    input->open();
+}
+
+// batches left without rows are skipped
+RowBatch* Filter::next() {
+    for(RowBatch* batch = input->next(); batch != nullptr; batch = input->next()){
+        predicate.filter(*batch);
+        if(!batch->selection.empty()) return batch;
+    }
+    return nullptr;
+}
@@ -0,0 +1,23 @@
+#ifndef FILTER_HPP
+#define FILTER_HPP
+
+#include <memory>
+
+#include "../Operator/Operator.hpp"
+#include "../../storage/Predicate/Predicate.hpp"
+
+// narrows the batches of its input to the rows that satisfy the WHERE condition
+class Filter : public Operator {
+public:
+    Filter(std::unique_ptr<Operator>, const ASTree*, const TableSchema&);
+
+    void open() override;
+    RowBatch* next() override;
+
+private:
+    std::unique_ptr<Operator> input;
+    Predicate predicate;
+
+};
+
+#endif
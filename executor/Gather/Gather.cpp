@@ -0,0 +1,133 @@
+#include "Gather.hpp"
+
+#include <algorithm>
+
+Gather::Gather(std::vector<std::unique_ptr<Operator>> inputs, ThreadPool& pool, size_t width, bool ordered) :
+    pool{ pool }, width{ width }, ordered{ ordered }, types{ batch_types(inputs.front()->get_fields()) }, current{ 0 }, workers{ 0 },
+    cancelled{ false }, output{ types } {
+    fields = inputs.front()->get_fields();
+    for(auto& input : inputs){
+        parts.push_back(Part{ std::move(input), {}, PartState::PENDING });
+    }
+}
+
+// workers still running hold pointers into the parts, they stop at their next batch
+Gather::~Gather() {
+    std::unique_lock lock{ latch };
+    cancelled = true;
+    changed.notify_all();
+    changed.wait(lock, [this]{ return workers == 0; });
+}
+
+void Gather::open() {
+    const size_t helpers{ std::min({ width > 0 ? width - 1 : 0, pool.size(), parts.size() }) };
+    {
+        std::lock_guard guard{ latch };
+        workers = helpers;
+    }
+    for(size_t i = 0; i < helpers; ++i){
+        pool.submit([this]{ produce(); });
+    }
+}
+
+RowBatch* Gather::next() {
+    if(streaming.has_value()){
+        if(RowBatch* batch = stream(*streaming)) return batch;
+    }
+    std::unique_lock lock{ latch };
+    for(;;){
+        if(error) std::rethrow_exception(error);
+
+        std::optional<size_t> pending;
+        bool running{ false };
+        for(size_t i = current; i < parts.size(); ++i){
+            Part& part{ parts[i] };
+            if(!part.ready.empty()) return take(part);
+            if(part.state == PartState::PENDING && !pending.has_value()) pending = i;
+            running = running || part.state == PartState::RUNNING;
+            if(ordered && part.state != PartState::DONE) break;
+            if(i == current && part.state == PartState::DONE) ++current;
+        }
+        if(pending.has_value()){
+            parts[*pending].state = PartState::INLINE;
+            streaming = pending;
+            lock.unlock();
+            parts[*pending].input->open();
+            if(RowBatch* batch = stream(*pending)) return batch;
+            lock.lock();
+            continue;
+        }
+        if(!running) return nullptr;
+        changed.wait(lock);
+    }
+}
+
+// claims parts in order until none is left, the rows of each are copied into full batches
+void Gather::produce() {
+    for(;;){
+        Part* part{ nullptr };
+        {
+            std::lock_guard guard{ latch };
+            if(cancelled) break;
+            for(auto& candidate : parts){
+                if(candidate.state == PartState::PENDING){
+                    candidate.state = PartState::RUNNING;
+                    part = &candidate;
+                    break;
+                }
+            }
+        }
+        if(part == nullptr) break;
+
+        try{
+            part->input->open();
+            RowBatch batch{ types };
+            bool open{ true };
+            for(RowBatch* input = part->input->next(); open && input != nullptr; input = part->input->next()){
+                for(size_t first = 0; open && first < input->selection.size();){
+                    first = batch.append(*input, first);
+                    if(batch.size == BATCH_SIZE) open = publish(*part, batch);
+                }
+            }
+            if(open && batch.size > 0) publish(*part, batch);
+        }
+        catch(...){
+            std::lock_guard guard{ latch };
+            if(!error) error = std::current_exception();
+            cancelled = true;
+        }
+        std::lock_guard guard{ latch };
+        part->state = PartState::DONE;
+        changed.notify_all();
+    }
+    std::lock_guard guard{ latch };
+    --workers;
+    changed.notify_all();
+}
+
+// false once the gather is cancelled, the batch starts over empty
+bool Gather::publish(Part& part, RowBatch& batch) {
+    std::unique_lock lock{ latch };
+    changed.wait(lock, [this, &part]{ return cancelled || part.ready.size() < MAX_READY; });
+    if(cancelled) return false;
+    batch.select_all();
+    part.ready.push_back(std::move(batch));
+    batch = RowBatch{ types };
+    changed.notify_all();
+    return true;
+}
+
+RowBatch* Gather::take(Part& part) {
+    output = std::move(part.ready.front());
+    part.ready.pop_front();
+    changed.notify_all();
+    return &output;
+}
+
+RowBatch* Gather::stream(size_t index) {
+    if(RowBatch* batch = parts[index].input->next()) return batch;
+    std::lock_guard guard{ latch };
+    parts[index].state = PartState::DONE;
+    streaming.reset();
+    return nullptr;
+}
@@ -0,0 +1,60 @@
+#ifndef GATHER_HPP
+#define GATHER_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "../Operator/Operator.hpp"
+#include "../ThreadPool/ThreadPool.hpp"
+
+// hands out the rows of several pipelines over consecutive parts of a table, each part runs to its end on one thread,
+// a pool worker or the caller once nothing else is ready, parts are claimed in order and keep the order of their rows,
+// ordered parts follow each other, otherwise a part's rows go out as soon as they are ready
+class Gather : public Operator {
+public:
+    // at most width threads run parts at once, the caller included
+    Gather(std::vector<std::unique_ptr<Operator>>, ThreadPool&, size_t, bool);
+    ~Gather() override;
+
+    void open() override;
+    RowBatch* next() override;
+
+private:
+    enum class PartState : uint8_t { PENDING, RUNNING, INLINE, DONE };
+
+    // ready holds the compacted batches a worker produced and the caller did not take yet
+    struct Part {
+        std::unique_ptr<Operator> input;
+        std::deque<RowBatch> ready;
+        PartState state;
+    };
+
+    static constexpr size_t MAX_READY = 4; // batches a worker gets ahead of the caller on one part
+
+    std::vector<Part> parts;
+    ThreadPool& pool;
+    size_t width;
+    bool ordered;
+    std::vector<FieldType> types;
+    std::mutex latch;
+    std::condition_variable changed;
+    size_t current;                  // first part that is not handed out completely, in order
+    std::optional<size_t> streaming; // part the caller runs itself
+    size_t workers;                  // worker tasks still running
+    bool cancelled;
+    std::exception_ptr error;
+    RowBatch output;
+
+    void produce();
+    bool publish(Part&, RowBatch&);
+    RowBatch* take(Part&);
+    RowBatch* stream(size_t);
+
+};
+
+#endif
@@ -0,0 +1,28 @@
+#include "IndexScan.hpp"
+
+#include "../../storage/SecondaryIndex/SecondaryIndex.hpp"
+
+template<size_t PageSize>
+IndexScan<PageSize>::IndexScan(const TableSchema& table_schema, const Index& index, const std::string& table_path, const std::string& index_path,
+    BufferManager& buffer_manager, const AccessPath& access_path, const std::vector<size_t>& columns) :
+    table_schema{ table_schema }, index{ index }, table_path{ table_path }, index_path{ index_path }, buffer_manager{ buffer_manager }, access_path{ access_path },
+    columns{ columns } {
+    fields = record_fields(table_schema, columns);
+}
+
+template<size_t PageSize>
+void IndexScan<PageSize>::open() {
+    access_path.keys = SecondaryIndex<PageSize>{ table_schema, index, index_path }.primary_keys(access_path, buffer_manager);
+    table_scan.emplace(table_schema, table_path, buffer_manager, access_path, columns);
+    table_scan->open();
+}
+
+template<size_t PageSize>
+RowBatch* IndexScan<PageSize>::next() {
+    return table_scan->next();
+}
+
+template class IndexScan<4096>;
+template class IndexScan<8192>;
+template class IndexScan<16384>;
+template class IndexScan<65536>;
@@ -0,0 +1,34 @@
+#ifndef INDEX_SCAN_HPP
+#define INDEX_SCAN_HPP
+
+#include <optional>
+#include <string>
+
+#include "../Operator/Operator.hpp"
+#include "../TableScan/TableScan.hpp"
+#include "../../storage/BufferManager/BufferManager.hpp"
+#include "../../planner/planner.hpp"
+
+// rows whose indexed column falls inside the planned range, the index is read for their primary keys when the scan opens
+// and the rows are then looked up in key order
+template<size_t PageSize>
+class IndexScan : public Operator {
+public:
+    IndexScan(const TableSchema&, const Index&, const std::string&, const std::string&, BufferManager&, const AccessPath&, const std::vector<size_t>&);
+
+    void open() override;
+    RowBatch* next() override;
+
+private:
+    TableSchema table_schema;
+    Index index;
+    std::string table_path;
+    std::string index_path;
+    BufferManager& buffer_manager;
+    AccessPath access_path;
+    std::vector<size_t> columns;
+    std::optional<TableScan<PageSize>> table_scan;
+
+};
+
+#endif
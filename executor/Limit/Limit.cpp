@@ -0,0 +1,34 @@
+#include "Limit.hpp"
+
+#include <algorithm>
+
+Limit::Limit(std::unique_ptr<Operator> input, size_t limit, size_t offset) : input{ std::move(input) }, limit{ limit }, offset{ offset }, produced{ 0 } {
+    fields = this->input->get_fields();
+}
+
+// with no rows wanted the input is never opened, otherwise its fields are taken again since an aggregate
+// only knows which of its values are NULL once it is open
+void Limit::open() {
+    produced = 0;
+    if(limit == 0) return;
+    input->open();
+    fields = input->get_fields();
+}
+
+// skipped rows are cut from the front of the selection and rows past the limit from its back
+RowBatch* Limit::next() {
+    while(produced < limit){
+        RowBatch* batch{ input->next() };
+        if(batch == nullptr) return nullptr;
+        std::vector<uint16_t>& selection{ batch->selection };
+        const size_t skipped{ std::min(offset, selection.size()) };
+        selection.erase(selection.begin(), selection.begin() + static_cast<std::ptrdiff_t>(skipped));
+        offset -= skipped;
+        if(selection.size() > limit - produced){
+            selection.resize(limit - produced);
+        }
+        produced += selection.size();
+        if(!selection.empty()) return batch;
+    }
+    return nullptr;
+}
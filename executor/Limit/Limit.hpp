@@ -0,0 +1,25 @@
+#ifndef LIMIT_HPP
+#define LIMIT_HPP
+
+#include <memory>
+
+#include "../Operator/Operator.hpp"
+
+// skips the first offset rows of its input and passes on at most limit of the rest,
+// the input is not asked for more rows once the limit is reached
+class Limit : public Operator {
+public:
+    Limit(std::unique_ptr<Operator>, size_t, size_t);
+
+    void open() override;
+    RowBatch* next() override;
+
+private:
+    std::unique_ptr<Operator> input;
+    size_t limit;
+    size_t offset;
+    size_t produced;
+
+};
+
+#endif
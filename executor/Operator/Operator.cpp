@@ -0,0 +1,33 @@
+#include "Operator.hpp"
+
+const std::vector<Field>& Operator::get_fields() const noexcept {
+    return fields;
+}
+
+std::vector<Field> Operator::record_fields(const TableSchema& table_schema, const std::vector<size_t>& columns) {
+    std::vector<Field> record;
+    for(size_t column : columns){
+        const Column& schema_column{ table_schema.get_column_at(column) };
+        record.push_back(Field{ schema_column.name, schema_column.type == DataType::NUMBER ? FieldType::NUMBER : FieldType::VARCHAR, column });
+    }
+    return record;
+}
+
+std::vector<FieldType> Operator::batch_types(const std::vector<Field>& fields) {
+    std::vector<FieldType> types;
+    for(const auto& field : fields){
+        if(field.column >= types.size()){
+            types.resize(field.column + 1, FieldType::NONE);
+        }
+        types[field.column] = field.type;
+    }
+    return types;
+}
+
+std::vector<size_t> Operator::field_columns(const std::vector<Field>& fields) {
+    std::vector<size_t> columns;
+    for(const auto& field : fields){
+        columns.push_back(field.column);
+    }
+    return columns;
+}
@@ -0,0 +1,41 @@
+#ifndef OPERATOR_HPP
+#define OPERATOR_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../RowBatch/RowBatch.hpp"
+
+// one output column, column is its position in the batches the operator hands out
+struct Field {
+    std::string name;
+    FieldType type;
+    size_t column;
+};
+
+// a step of a SELECT pipeline, batches are pulled from the top: open prepares the operator and its inputs,
+// next hands out a batch with at least one selected row and nullptr once there are no more,
+// a batch stays valid until the following call, the caller may narrow its selection
+class Operator {
+public:
+    virtual ~Operator() = default;
+
+    virtual void open() = 0;
+    virtual RowBatch* next() = 0;
+
+    // known once the operator is constructed, only the type of a value open finds missing changes to NONE
+    const std::vector<Field>& get_fields() const noexcept;
+
+protected:
+    std::vector<Field> fields;
+
+    // the listed columns of a stored record, each keeps its declaration index as its batch column
+    static std::vector<Field> record_fields(const TableSchema&, const std::vector<size_t>&);
+    // column types of a batch holding the fields, columns without a field are NONE
+    static std::vector<FieldType> batch_types(const std::vector<Field>&);
+    static std::vector<size_t> field_columns(const std::vector<Field>&);
+
+};
+
+#endif
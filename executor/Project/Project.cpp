@@ -0,0 +1,29 @@
+#include "Project.hpp"
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+// column names are resolved to fields of the input once
+Project::Project(std::unique_ptr<Operator> input, const std::vector<std::string>& columns) : input{ std::move(input) } {
+    const std::vector<Field>& available{ this->input->get_fields() };
+    if(columns.empty()){
+        fields = available;
+        return;
+    }
+    for(const auto& column : columns){
+        auto field = std::find_if(available.begin(), available.end(), [&column](const Field& field){ return field.name == column; });
+        if(field == available.end()){
+            throw std::runtime_error(std::format("Unknown column '{}'\n", column));
+        }
+        fields.push_back(*field);
+    }
+}
+
+void Project::open() {
+    input->open();
+}
+
+RowBatch* Project::next() {
+    return input->next();
+}
@@ -0,0 +1,25 @@
+#ifndef PROJECT_HPP
+#define PROJECT_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Operator/Operator.hpp"
+
+// narrows the rows of its input to the selected columns in the order they were asked for,
+// batches are passed on as they are, only the fields change
+class Project : public Operator {
+public:
+    // no column names keep every column
+    Project(std::unique_ptr<Operator>, const std::vector<std::string>&);
+
+    void open() override;
+    RowBatch* next() override;
+
+private:
+    std::unique_ptr<Operator> input;
+
+};
+
+#endif
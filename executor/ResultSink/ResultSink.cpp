@@ -0,0 +1,65 @@
+#include "ResultSink.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <stdexcept>
+
+ResultSink::ResultSink(std::ostream& out) : out{ out }, buffer(SINK_BUFFER_SIZE), used{ 0 } {}
+
+size_t ResultSink::write(Operator& root) {
+    root.open();
+    const auto& fields = root.get_fields();
+    begin(fields);
+    size_t rows{ 0 };
+    for(const RowBatch* batch = root.next(); batch != nullptr; batch = root.next()){
+        for(uint16_t i : batch->selection){
+            row(*batch, i, fields);
+        }
+        rows += batch->selection.size();
+    }
+    end(rows);
+    flush();
+    return rows;
+}
+
+char* ResultSink::reserve(size_t size) {
+    if(used + size > buffer.size()){
+        flush();
+        if(size > buffer.size()){
+            buffer.resize(size);
+        }
+    }
+    return buffer.data() + used;
+}
+
+void ResultSink::commit(size_t size) noexcept {
+    used += size;
+}
+
+void ResultSink::append(std::string_view value) {
+    std::memcpy(reserve(value.size()), value.data(), value.size());
+    commit(value.size());
+}
+
+void ResultSink::append(char value) {
+    *reserve(1) = value;
+    commit(1);
+}
+
+void ResultSink::append_number(uint64_t value) {
+    constexpr size_t MAX_DIGITS = std::numeric_limits<uint64_t>::digits10 + 1;
+    char* first = reserve(MAX_DIGITS);
+    auto [last, error] = std::to_chars(first, first + MAX_DIGITS, value);
+    commit(static_cast<size_t>(last - first));
+}
+
+void ResultSink::flush() {
+    if(used == 0) return;
+    out.write(buffer.data(), static_cast<std::streamsize>(used));
+    used = 0;
+    if(!out){
+        throw std::runtime_error(std::format("Unable to write the result\n"));
+    }
+}
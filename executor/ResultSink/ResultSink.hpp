@@ -0,0 +1,50 @@
+#ifndef RESULT_SINK_HPP
+#define RESULT_SINK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "../Operator/Operator.hpp"
+
+constexpr size_t SINK_BUFFER_SIZE = 64 * 1024; // bytes gathered before they are handed to the stream
+
+// TEXT is the human readable "column: value|" form, CSV and BINARY are meant for programs reading the results
+enum class OutputFormat { TEXT, CSV, BINARY };
+
+// pulls every row out of the top of a pipeline and writes it in some format, values are gathered in a buffer
+// kept across results that goes to the stream when it fills up and once a result is complete
+class ResultSink {
+public:
+    explicit ResultSink(std::ostream&);
+    virtual ~ResultSink() = default;
+    ResultSink(const ResultSink&) = delete;
+    ResultSink& operator=(const ResultSink&) = delete;
+
+    // returns the number of rows written
+    size_t write(Operator&);
+
+protected:
+    virtual void begin(const std::vector<Field>&) = 0;
+    virtual void row(const RowBatch&, size_t, const std::vector<Field>&) = 0;
+    virtual void end(size_t) = 0;
+
+    // room for at least the given number of bytes, returns where they go, commit counts the ones used
+    char* reserve(size_t);
+    void commit(size_t) noexcept;
+
+    void append(std::string_view);
+    void append(char);
+    void append_number(uint64_t);
+    void flush();
+
+private:
+    std::ostream& out;
+    std::vector<char> buffer;
+    size_t used;
+
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "RowBatch.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <numeric>
+
+RowBatch::RowBatch(const std::vector<FieldType>& types) : size{ 0 }, columns(types.size()) {
+    for(size_t i = 0; i < types.size(); ++i){
+        switch(types[i]){
+            case FieldType::NUMBER:
+                columns[i].numbers.resize(BATCH_SIZE);
+                break;
+            case FieldType::COUNT:
+                columns[i].counts.resize(BATCH_SIZE);
+                break;
+            case FieldType::VARCHAR:
+                columns[i].strings.resize(BATCH_SIZE * MAX_STRING_LEN);
+                break;
+            case FieldType::NONE:
+                break;
+        }
+    }
+    selection.reserve(BATCH_SIZE);
+}
+
+void RowBatch::clear() noexcept {
+    size = 0;
+    selection.clear();
+}
+
+void RowBatch::select_all() {
+    selection.resize(size);
+    std::iota(selection.begin(), selection.end(), uint16_t{ 0 });
+}
+
+// one column at a time, so each pass is a plain copy loop, keys are stored big-endian and swapped once here
+void RowBatch::decode(const char* const* records, size_t count, const std::vector<ColumnLayout>& layout, const std::vector<size_t>& decoded) {
+    for(size_t c : decoded){
+        const size_t offset{ layout[c].offset };
+        if(layout[c].type == DataType::VARCHAR){
+            char* values{ columns[c].strings.data() + size * MAX_STRING_LEN };
+            for(size_t r = 0; r < count; ++r){
+                std::memcpy(values + r * MAX_STRING_LEN, records[r] + offset, MAX_STRING_LEN);
+            }
+            continue;
+        }
+        uint32_t* values{ columns[c].numbers.data() + size };
+        for(size_t r = 0; r < count; ++r){
+            std::memcpy(values + r, records[r] + offset, sizeof(uint32_t));
+        }
+        if constexpr(std::endian::native == std::endian::little){
+            if(layout[c].is_key){
+                for(size_t r = 0; r < count; ++r){
+                    values[r] = std::byteswap(values[r]);
+                }
+            }
+        }
+    }
+    size += count;
+}
+
+void RowBatch::encode(size_t row, const std::vector<ColumnLayout>& layout, const std::vector<size_t>& encoded, char* record) const {
+    for(size_t c : encoded){
+        if(layout[c].type == DataType::VARCHAR){
+            std::memcpy(record + layout[c].offset, columns[c].strings.data() + row * MAX_STRING_LEN, MAX_STRING_LEN);
+            continue;
+        }
+        uint32_t number{ columns[c].numbers[row] };
+        if constexpr(std::endian::native == std::endian::little){
+            if(layout[c].is_key) number = std::byteswap(number);
+        }
+        std::memcpy(record + layout[c].offset, &number, sizeof(number));
+    }
+}
+
+size_t RowBatch::append(const RowBatch& source, size_t first) {
+    const size_t count{ std::min(BATCH_SIZE - size, source.selection.size() - first) };
+    const uint16_t* rows{ source.selection.data() + first };
+    for(size_t c = 0; c < columns.size(); ++c){
+        const ColumnVector& from{ source.columns[c] };
+        ColumnVector& to{ columns[c] };
+        if(!to.numbers.empty()){
+            for(size_t r = 0; r < count; ++r) to.numbers[size + r] = from.numbers[rows[r]];
+        }
+        else if(!to.counts.empty()){
+            for(size_t r = 0; r < count; ++r) to.counts[size + r] = from.counts[rows[r]];
+        }
+        else if(!to.strings.empty()){
+            for(size_t r = 0; r < count; ++r){
+                std::memcpy(to.strings.data() + (size + r) * MAX_STRING_LEN, from.strings.data() + rows[r] * MAX_STRING_LEN, MAX_STRING_LEN);
+            }
+        }
+    }
+    size += count;
+    return first + count;
+}
+
+std::string_view RowBatch::string_at(size_t column, size_t row) const noexcept {
+    const char* value{ columns[column].strings.data() + row * MAX_STRING_LEN };
+    return std::string_view{ value, static_cast<size_t>(std::find(value, value + MAX_STRING_LEN, '\0') - value) };
+}
@@ -0,0 +1,48 @@
+#ifndef ROW_BATCH_HPP
+#define ROW_BATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "../../SchemaCatalog/TableSchema/TableSchema.hpp"
+
+constexpr size_t BATCH_SIZE = 1024; // rows operators hand to each other at once
+
+// how the values of a column are stored in a batch, NONE columns hold no value and read as NULL
+enum class FieldType : uint8_t { NUMBER, VARCHAR, COUNT, NONE };
+
+// NUMBER values, with keys already in native byte order, COUNT values, or VARCHAR values in MAX_STRING_LEN byte slots padded with '\0'
+struct ColumnVector {
+    std::vector<uint32_t> numbers;
+    std::vector<uint64_t> counts;
+    std::vector<char> strings;
+};
+
+// up to BATCH_SIZE rows stored column by column, NONE columns take no memory, selection lists the rows still in the batch in ascending order,
+// operators further up narrow it instead of moving values
+struct RowBatch {
+    size_t size;
+    std::vector<ColumnVector> columns;
+    std::vector<uint16_t> selection;
+
+    explicit RowBatch(const std::vector<FieldType>&);
+
+    void clear() noexcept;
+    void select_all();
+
+    // appends records laid out as the table's layout describes, column i of the batch is column i of the table,
+    // only the listed columns are read, the others stay empty
+    void decode(const char* const*, size_t, const std::vector<ColumnLayout>&, const std::vector<size_t>&);
+    // writes the listed columns of a row back in the stored layout
+    void encode(size_t, const std::vector<ColumnLayout>&, const std::vector<size_t>&, char*) const;
+
+    // appends the selected rows of a batch with the same column types, starting at the given position of its selection,
+    // until this batch is full, returns the position of the first selected row left out
+    size_t append(const RowBatch&, size_t);
+
+    std::string_view string_at(size_t, size_t) const noexcept;
+};
+
+#endif
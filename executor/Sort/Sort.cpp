@@ -0,0 +1,32 @@
+#include "Sort.hpp"
+
+Sort::Sort(std::unique_ptr<Operator> input, const TableSchema& table_schema, const std::string& column_name, size_t memory_budget,
+    const std::filesystem::path& temp_path, size_t limit) :
+    input{ std::move(input) }, sorter{ table_schema, column_name, memory_budget, temp_path, limit }, layout{ table_schema.get_layout() },
+    columns{ field_columns(this->input->get_fields()) }, record(table_schema.get_record_size()), batch{ batch_types(this->input->get_fields()) } {
+    fields = this->input->get_fields();
+}
+
+void Sort::open() {
+    input->open();
+    for(RowBatch* rows = input->next(); rows != nullptr; rows = input->next()){
+        for(uint16_t row : rows->selection){
+            rows->encode(row, layout, columns, record.data());
+            sorter.add(record.data());
+        }
+    }
+    sorter.finish();
+}
+
+// a sorted row is only valid until the sorter hands out the next one, so rows are decoded one by one
+RowBatch* Sort::next() {
+    batch.clear();
+    while(batch.size < BATCH_SIZE){
+        const char* sorted{ sorter.next() };
+        if(sorted == nullptr) break;
+        batch.decode(&sorted, 1, layout, columns);
+    }
+    if(batch.size == 0) return nullptr;
+    batch.select_all();
+    return &batch;
+}
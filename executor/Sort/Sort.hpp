@@ -0,0 +1,33 @@
+#ifndef SORT_HPP
+#define SORT_HPP
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Operator/Operator.hpp"
+#include "../../storage/Sorter/Sorter.hpp"
+
+// orders the rows of its input by one column, every input row is read when the sort opens,
+// the input's batch columns are those of the table and rows go through the sorter in their stored layout,
+// only the columns the input decoded are carried over
+class Sort : public Operator {
+public:
+    // only the first limit rows are ever asked for
+    Sort(std::unique_ptr<Operator>, const TableSchema&, const std::string&, size_t, const std::filesystem::path&, size_t limit = SIZE_MAX);
+
+    void open() override;
+    RowBatch* next() override;
+
+private:
+    std::unique_ptr<Operator> input;
+    Sorter sorter;
+    std::vector<ColumnLayout> layout;
+    std::vector<size_t> columns;
+    std::vector<char> record;
+    RowBatch batch;
+
+};
+
+#endif
@@ -0,0 +1,33 @@
+#include "TableScan.hpp"
+
+template<size_t PageSize>
+TableScan<PageSize>::TableScan(const TableSchema& table_schema, const std::string& table_path, BufferManager& buffer_manager, const AccessPath& access_path,
+    const std::vector<size_t>& columns, const LeafSpan& span) :
+    btree{ table_schema }, table_path{ table_path }, buffer_manager{ buffer_manager }, access_path{ access_path }, span{ span }, layout{ table_schema.get_layout() },
+    columns{ columns }, batch{ batch_types(record_fields(table_schema, columns)) }, records{} {
+    fields = record_fields(table_schema, columns);
+}
+
+template<size_t PageSize>
+void TableScan<PageSize>::open() {
+    cursor.emplace(btree, table_path, buffer_manager, access_path, span);
+}
+
+// the rows of a leaf are only valid while the cursor stays on it, so they are decoded a leaf at a time
+template<size_t PageSize>
+RowBatch* TableScan<PageSize>::next() {
+    batch.clear();
+    while(batch.size < BATCH_SIZE){
+        const size_t count{ cursor->next_rows(records.data(), BATCH_SIZE - batch.size) };
+        if(count == 0) break;
+        batch.decode(records.data(), count, layout, columns);
+    }
+    if(batch.size == 0) return nullptr;
+    batch.select_all();
+    return &batch;
+}
+
+template class TableScan<4096>;
+template class TableScan<8192>;
+template class TableScan<16384>;
+template class TableScan<65536>;
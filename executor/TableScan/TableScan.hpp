@@ -0,0 +1,38 @@
+#ifndef TABLE_SCAN_HPP
+#define TABLE_SCAN_HPP
+
+#include <array>
+#include <optional>
+#include <string>
+
+#include "../Operator/Operator.hpp"
+#include "../../storage/BTree/BTree.hpp"
+#include "../../storage/BufferManager/BufferManager.hpp"
+#include "../../planner/planner.hpp"
+
+// rows of a table in key order, all of them or only those inside the planned key range or the given leaves,
+// only the columns the query reads are decoded into the batch, each of them once
+template<size_t PageSize>
+class TableScan : public Operator {
+public:
+    // columns are declaration indexes in ascending order
+    TableScan(const TableSchema&, const std::string&, BufferManager&, const AccessPath&, const std::vector<size_t>&, const LeafSpan& = LeafSpan{});
+
+    void open() override;
+    RowBatch* next() override;
+
+private:
+    BTree<PageSize> btree;
+    std::string table_path;
+    BufferManager& buffer_manager;
+    AccessPath access_path;
+    LeafSpan span;
+    std::vector<ColumnLayout> layout;
+    std::vector<size_t> columns;
+    std::optional<typename BTree<PageSize>::Cursor> cursor;
+    RowBatch batch;
+    std::array<const char*, BATCH_SIZE> records;
+
+};
+
+#endif
@@ -0,0 +1,41 @@
+#include "TextSink.hpp"
+
+namespace {
+
+constexpr std::string_view SEPARATOR{ "----------------------------------------\n" };
+
+}
+
+TextSink::TextSink(std::ostream& out) : ResultSink{ out } {}
+
+void TextSink::begin(const std::vector<Field>&) {
+    append(SEPARATOR);
+}
+
+void TextSink::row(const RowBatch& batch, size_t row, const std::vector<Field>& fields) {
+    for(const auto& field : fields){
+        append(field.name);
+        append(": ");
+        switch(field.type){
+            case FieldType::NUMBER:
+                append_number(batch.columns[field.column].numbers[row]);
+                break;
+            case FieldType::COUNT:
+                append_number(batch.columns[field.column].counts[row]);
+                break;
+            case FieldType::VARCHAR:
+                append(batch.string_at(field.column, row));
+                break;
+            case FieldType::NONE:
+                append("NULL");
+                break;
+        }
+        append('|');
+    }
+    append('\n');
+}
+
+void TextSink::end(size_t) {
+    append(SEPARATOR);
+    append('\n');
+}
@@ -0,0 +1,18 @@
+#ifndef TEXT_SINK_HPP
+#define TEXT_SINK_HPP
+
+#include "../ResultSink/ResultSink.hpp"
+
+// "column: value|" pairs, one row per line, the result is framed by separator lines
+class TextSink : public ResultSink {
+public:
+    explicit TextSink(std::ostream&);
+
+protected:
+    void begin(const std::vector<Field>&) override;
+    void row(const RowBatch&, size_t, const std::vector<Field>&) override;
+    void end(size_t) override;
+
+};
+
+#endif
@@ -0,0 +1,123 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+ThreadPool::ThreadPool(size_t size) : queued{ 0 }, next_queue{ 0 }, stopping{ false } {
+    for(size_t i = 0; i < size; ++i){
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for(size_t i = 0; i < size; ++i){
+        workers.emplace_back([this, i]{ work(i); });
+    }
+}
+
+// tasks still queued are run before the workers exit
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard guard{ latch };
+        stopping = true;
+    }
+    wake.notify_all();
+    for(auto& worker : workers){
+        worker.join();
+    }
+}
+
+size_t ThreadPool::size() const noexcept {
+    return workers.size();
+}
+
+// without workers the task runs right away
+void ThreadPool::submit(std::function<void()> task) {
+    if(workers.empty()){
+        task();
+        return;
+    }
+    size_t target;
+    {
+        std::lock_guard guard{ latch };
+        target = next_queue;
+        next_queue = (next_queue + 1) % queues.size();
+    }
+    {
+        std::lock_guard guard{ queues[target]->latch };
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard guard{ latch };
+        ++queued;
+    }
+    wake.notify_one();
+}
+
+// indexes are handed out one at a time, so threads that finish early take over the remaining ones
+void ThreadPool::run(size_t count, size_t width, const std::function<void(size_t)>& task) {
+    struct Shared {
+        std::atomic<size_t> next{ 0 };
+        std::mutex latch;
+        std::condition_variable finished;
+        size_t helpers{ 0 };
+        std::exception_ptr error;
+    };
+    auto shared = std::make_shared<Shared>();
+    auto drain = [shared, count, &task]{
+        for(size_t i = shared->next++; i < count; i = shared->next++){
+            try{
+                task(i);
+            }
+            catch(...){
+                std::lock_guard guard{ shared->latch };
+                if(!shared->error) shared->error = std::current_exception();
+                shared->next = count;
+            }
+        }
+    };
+
+    const size_t helpers{ std::min({ width > 0 ? width - 1 : 0, workers.size(), count > 0 ? count - 1 : 0 }) };
+    shared->helpers = helpers;
+    for(size_t i = 0; i < helpers; ++i){
+        submit([shared, drain]{
+            drain();
+            std::lock_guard guard{ shared->latch };
+            if(--shared->helpers == 0) shared->finished.notify_all();
+        });
+    }
+    drain();
+
+    std::unique_lock lock{ shared->latch };
+    shared->finished.wait(lock, [&shared]{ return shared->helpers == 0; });
+    if(shared->error) std::rethrow_exception(shared->error);
+}
+
+void ThreadPool::work(size_t self) {
+    for(;;){
+        {
+            std::unique_lock lock{ latch };
+            wake.wait(lock, [this]{ return stopping || queued > 0; });
+            if(queued == 0) return;
+            --queued;
+        }
+        // the task counted above is in some deque already, it was pushed before the count went up
+        take(self)();
+    }
+}
+
+std::function<void()> ThreadPool::take(size_t self) {
+    for(size_t i = 0;; i = (i + 1) % queues.size()){
+        Queue& queue{ *queues[(self + i) % queues.size()] };
+        std::lock_guard guard{ queue.latch };
+        if(queue.tasks.empty()) continue;
+        std::function<void()> task;
+        if(i == 0){
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else{
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        return task;
+    }
+}
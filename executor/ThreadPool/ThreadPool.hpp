@@ -0,0 +1,50 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// a fixed set of workers, each with its own deque of tasks: a worker runs the newest task of its own deque
+// and steals the oldest task of another one once its own is empty, submitted tasks are dealt out in turn
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const noexcept;
+
+    // tasks must not throw
+    void submit(std::function<void()>);
+
+    // calls task with every index below count using at most width threads, the calling thread among them,
+    // returns once all calls are done and rethrows the first exception one of them threw
+    void run(size_t, size_t, const std::function<void(size_t)>&);
+
+private:
+    struct Queue {
+        std::mutex latch;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex latch;
+    std::condition_variable wake;
+    size_t queued;
+    size_t next_queue;
+    bool stopping;
+
+    void work(size_t);
+    std::function<void()> take(size_t);
+
+};
+
+#endif
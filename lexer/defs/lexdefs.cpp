@@ -22,6 +22,16 @@ const std::unordered_map<std::string, TokenType> keywords {
     {"OR", TokenType::OR},
     {"PRIMARY", TokenType::PRIMARY},
     {"KEY", TokenType::KEY},
+    {"PAGESIZE", TokenType::PAGESIZE},
+    {"COPY", TokenType::COPY},
+    {"FILLFACTOR", TokenType::FILLFACTOR},
+    {"INDEX", TokenType::INDEX},
+    {"ON", TokenType::ON},
+    {"OFFSET", TokenType::OFFSET},
+    {"COUNT", TokenType::COUNT},
+    {"SUM", TokenType::SUM},
+    {"MIN", TokenType::MIN},
+    {"MAX", TokenType::MAX},
     {"NULL", TokenType::_NULL}
 };
 
@@ -2,7 +2,13 @@
 #include <format>
 #include <iostream>
 #include <cassert>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "QueryExecutor/QueryExecutor.hpp"
 #include "SchemaCatalog/SchemaCatalog/SchemaCatalog.hpp"
@@ -11,10 +17,14 @@
 #include "analyzer/analyzer.hpp"
 #include "storage/BTree/BTree.hpp"
 #include "storage/BufferManager/BufferManager.hpp"
+#include "storage/KeySearch/KeySearch.hpp"
+
+using namespace std::string_literals;
 
 enum class Error { LEXICAL_ERR, SYNTAX_ERR, SEMANTIC_ERR, NO_ERR };
 
-Error mini_test(const std::string& script){
+Error mini_test(const std::string& script, StorageMode storage_mode = StorageMode::BUFFERED, OutputFormat output_format = OutputFormat::TEXT,
+    size_t threads = std::thread::hardware_concurrency(), size_t sort_memory = DEFAULT_SORT_MEMORY){
     Lexer lex(script);
     try{
         lex.tokenize();
@@ -27,15 +37,15 @@ Error mini_test(const std::string& script){
             //ast->traverse(0);
             
             SchemaCatalog sc{};
-            BufferManager bf{};
-            bf.load_schema("metadata/schema/schema.db", sc);
+            BufferManager bf{ DEFAULT_FRAME_COUNT, storage_mode };
+            bf.open_wal("metadata/wal/wal.log");
+            bf.load_schema("metadata/schema/schema.db", "metadata/tables/", sc);
             //sc.print_tables();
             Analyzer analyzer{sc};
             try{
                 analyzer.analyze_script(ast.get());
                 std::cout << "Script is valid.\n\n";
-                BTree btree;
-                QueryExecutor qexec{ sc, bf, btree };
+                QueryExecutor qexec{ sc, bf, sort_memory, output_format, threads };
                 qexec.execute_script(ast.get());
                 return Error::NO_ERR;
             }
@@ -53,11 +63,96 @@ Error mini_test(const std::string& script){
     }
 }
 
+// runs a script like mini_test and hands back what it printed, nothing if it failed
+std::string mini_test_output(const std::string& script, StorageMode storage_mode = StorageMode::BUFFERED, OutputFormat output_format = OutputFormat::TEXT,
+    size_t threads = std::thread::hardware_concurrency(), size_t sort_memory = DEFAULT_SORT_MEMORY){
+    std::ostringstream out;
+    std::streambuf* printed{ std::cout.rdbuf(out.rdbuf()) };
+    const Error error{ mini_test(script, storage_mode, output_format, threads, sort_memory) };
+    std::cout.rdbuf(printed);
+    return error == Error::NO_ERR ? out.str() : std::string{};
+}
+
+// what the TEXT sink prints for one result
+std::string text_result(const std::vector<std::string>& rows){
+    std::string text{ "----------------------------------------\n" };
+    for(const auto& row : rows){
+        text += row + "\n";
+    }
+    return text + "----------------------------------------\n\n";
+}
+
+// every step-th key from first below last, with the key's digits as the row's second column
+void insert_keys(BTree<PAGE_SIZE_>& tree, BufferManager& bf, const TableSchema& table_schema, const std::string& table_path,
+    size_t first, size_t last, size_t step){
+    std::vector<char> record(table_schema.get_record_size());
+    for(size_t key = first; key < last; key += step){
+        const std::string value{ std::to_string(key) };
+        bf.row_to_record({ value, value }, table_schema, record.data());
+        tree.insert(record, bf, table_path);
+    }
+}
+
+// two threads insert the keys below rows into one tree, one the even and one the odd keys, through a pool small
+// enough to evict while both run, hands back how many rows a scan then finds in ascending key order
+size_t concurrent_insert(const std::string& table_name, size_t rows){
+    SchemaCatalog sc{};
+    BufferManager bf{ 16 };
+    bf.open_wal("metadata/wal/wal.log");
+    bf.load_schema("metadata/schema/schema.db", "metadata/tables/", sc);
+    const TableSchema& table_schema{ sc.get_table(table_name)->get() };
+    const std::string table_path{ std::format("metadata/tables/{}.db", table_name) };
+    BTree<PAGE_SIZE_> tree{ table_schema };
+
+    std::thread odd{ [&]{ insert_keys(tree, bf, table_schema, table_path, 1, rows, 2); } };
+    insert_keys(tree, bf, table_schema, table_path, 0, rows, 2);
+    odd.join();
+    bf.commit();
+
+    size_t in_order{ 0 };
+    std::vector<char> previous;
+    tree.scan(table_path, bf, AccessPath{}, [&](const char* record){
+        if(previous.empty() || std::memcmp(previous.data(), record, table_schema.get_key_size()) < 0){
+            ++in_order;
+        }
+        previous.assign(record, record + table_schema.get_key_size());
+        return true;
+    });
+    return in_order;
+}
+
+// leaves the table file as it was before rows were inserted and the log as a crash would, after the keys below
+// committed were committed and the keys from there below rows were logged without a commit record
+void crash_after_commit(const std::string& table_name, size_t committed, size_t rows){
+    const std::filesystem::path table_path{ std::format("metadata/tables/{}.db", table_name) };
+    const std::filesystem::path wal_path{ "metadata/wal/wal.log" };
+    {
+        SchemaCatalog sc{};
+        BufferManager bf{};
+        bf.open_wal(wal_path.string());
+        bf.load_schema("metadata/schema/schema.db", "metadata/tables/", sc);
+        const TableSchema& table_schema{ sc.get_table(table_name)->get() };
+        BTree<PAGE_SIZE_> tree{ table_schema };
+
+        std::filesystem::copy_file(table_path, table_path.string() + ".saved", std::filesystem::copy_options::overwrite_existing);
+        insert_keys(tree, bf, table_schema, table_path.string(), 0, committed, 1);
+        bf.commit();
+        insert_keys(tree, bf, table_schema, table_path.string(), committed, rows, 1);
+        bf.commit();
+        std::filesystem::copy_file(wal_path, wal_path.string() + ".saved", std::filesystem::copy_options::overwrite_existing);
+    }
+    // the manager wrote every page back and truncated the log on shutdown
+    std::filesystem::rename(table_path.string() + ".saved", table_path);
+    std::filesystem::rename(wal_path.string() + ".saved", wal_path);
+    std::filesystem::resize_file(wal_path, std::filesystem::file_size(wal_path) - sizeof(WalRecordHeader));
+}
+
 int main(){
     
     std::filesystem::path base = "metadata";
     std::filesystem::path schema = base / "schema";
     std::filesystem::path tables = base / "tables";
+    std::filesystem::path wal = base / "wal";
 
     if(!std::filesystem::exists(base)){
         std::filesystem::create_directory(base);
@@ -68,13 +163,18 @@ int main(){
     if(!std::filesystem::exists(tables)){
         std::filesystem::create_directory(tables);
     }
+    if(!std::filesystem::exists(wal)){
+        std::filesystem::create_directory(wal);
+    }
+    std::ofstream{ base / "copy.csv" } << "3, 'c, three'\n1,one\n\n2,'two'\n";
 
     std::string successful1{ std::format("{}{}", "CREATE TABLE something (PRIMARY KEY NUMBER A, VARCHAR B);",
                                                         "CREATE TABLE tab (VARCHAR A, PRIMARY KEY VARCHAR B, VARCHAR C, NUMBER X);") };
     std::string successful2{ std::format("{}{}", "DROP TABLE something;", 
                                                         "DROP TABLE tab;")};
     std::string successful3_setup = "CREATE TABLE tmp (PRIMARY KEY VARCHAR a, NUMBER b, VARCHAR c);";
-    std::string successful3 = std::format("{}{}{}{}{}{}{}{}{}{}{}", "INSERT INTO tmp (a,b) VALUES ('a1', 1);",
+    std::string successful3_index{ "CREATE INDEX tmpb ON tmp(b);" };
+    std::string successful3 = std::format("{}{}{}{}{}{}{}{}{}{}{}{}{}{}{}", "INSERT INTO tmp (a,b) VALUES ('a1', 1);",
                                                               "INSERT INTO tmp (a,b) VALUES ('a2', 2);",
                                                               "INSERT INTO tmp (a,b) VALUES ('a3', 3);",
                                                               "INSERT INTO tmp (a,b) VALUES ('a4', 4);",
@@ -84,25 +184,292 @@ int main(){
                                                               "INSERT INTO tmp (a,b) VALUES ('a8', 8);",
                                                               "SELECT * FROM tmp;",
                                                               "SELECT (a,b) FROM tmp;",
-                                                              "SELECT b FROM tmp;");
+                                                              "SELECT b FROM tmp;",
+                                                              "SELECT * FROM tmp WHERE (b > 2 AND b <= 5) OR a = 'a8';",
+                                                              "DELETE FROM tmp WHERE b < 3 OR 7 = b;",
+                                                              "SELECT * FROM tmp WHERE a != 'a4';",
+                                                              "SELECT a FROM tmp WHERE b >= 4 AND b < 7;");
+    const std::string successful3_output{ std::format("Script is valid.\n\n{}{}{}{}{}{}",
+        text_result({ "a: a1|b: 1|c: |", "a: a2|b: 2|c: |", "a: a3|b: 3|c: |", "a: a4|b: 4|c: |",
+            "a: a5|b: 5|c: |", "a: a6|b: 6|c: |", "a: a7|b: 7|c: |", "a: a8|b: 8|c: |" }),
+        text_result({ "a: a1|b: 1|", "a: a2|b: 2|", "a: a3|b: 3|", "a: a4|b: 4|", "a: a5|b: 5|", "a: a6|b: 6|", "a: a7|b: 7|", "a: a8|b: 8|" }),
+        text_result({ "b: 1|", "b: 2|", "b: 3|", "b: 4|", "b: 5|", "b: 6|", "b: 7|", "b: 8|" }),
+        text_result({ "a: a3|b: 3|c: |", "a: a4|b: 4|c: |", "a: a5|b: 5|c: |", "a: a8|b: 8|c: |" }),
+        text_result({ "a: a3|b: 3|c: |", "a: a5|b: 5|c: |", "a: a6|b: 6|c: |", "a: a8|b: 8|c: |" }),
+        text_result({ "a: a4|", "a: a5|", "a: a6|" })) };
+    std::string successful3_drop_index{ "DROP INDEX tmpb;" };
     std::string successful3_cleanup{ "DROP TABLE tmp;" };
+    std::string successful4_setup{ "CREATE TABLE wide (PRIMARY KEY NUMBER a, VARCHAR b) PAGESIZE 16384;" };
+    std::string successful4{ std::format("{}{}{}{}{}{}{}{}{}{}{}{}", "INSERT INTO wide (a,b) VALUES (2, 'b2');",
+                                                      "INSERT INTO wide (a,b) VALUES (1, 'b1');",
+                                                      "INSERT INTO wide (a,b) VALUES (5, 'b5'), (3, 'b3'), (4, 'b4');",
+                                                      "SELECT * FROM wide;",
+                                                      "SELECT b FROM wide WHERE a >= 3 AND b != 'b4';",
+                                                      "SELECT * FROM wide WHERE 4 = a;",
+                                                      "SELECT * FROM wide WHERE a > 1 ORDER BY b;",
+                                                      "SELECT b FROM wide ORDER BY a;",
+                                                      "SELECT * FROM wide LIMIT 2;",
+                                                      "SELECT * FROM wide ORDER BY b LIMIT 2 OFFSET 1;",
+                                                      "SELECT COUNT(*) FROM wide;",
+                                                      "SELECT (SUM(a), MIN(b), MAX(a)) FROM wide WHERE a > 2;") };
+    const std::string successful4_output{ std::format("Script is valid.\n\n{}{}{}{}{}{}{}{}{}",
+        text_result({ "a: 1|b: b1|", "a: 2|b: b2|", "a: 3|b: b3|", "a: 4|b: b4|", "a: 5|b: b5|" }),
+        text_result({ "b: b3|", "b: b5|" }),
+        text_result({ "a: 4|b: b4|" }),
+        text_result({ "a: 2|b: b2|", "a: 3|b: b3|", "a: 4|b: b4|", "a: 5|b: b5|" }),
+        text_result({ "b: b1|", "b: b2|", "b: b3|", "b: b4|", "b: b5|" }),
+        text_result({ "a: 1|b: b1|", "a: 2|b: b2|" }),
+        text_result({ "a: 2|b: b2|", "a: 3|b: b3|" }),
+        text_result({ "COUNT(*): 5|" }),
+        text_result({ "SUM(a): 12|MIN(b): b3|MAX(a): 5|" })) };
+    std::string successful4_cleanup{ "DROP TABLE wide;" };
+    std::string successful5_setup{ "CREATE TABLE loaded (PRIMARY KEY NUMBER id, VARCHAR name);" };
+    std::string successful5{ std::format("{}{}{}", "COPY loaded FROM 'metadata/copy.csv';",
+                                                    "COPY loaded FROM 'metadata/copy.csv' FILLFACTOR 50;",
+                                                    "SELECT * FROM loaded;") };
+    std::string successful5_cleanup{ "DROP TABLE loaded;" };
+    std::string successful6_setup{ "CREATE TABLE sink (PRIMARY KEY NUMBER a, VARCHAR b);" };
+    std::string successful6_insert{ "INSERT INTO sink (a,b) VALUES (1, 'one, two'), (2, 'NULL'), (3, 'three');" };
+    std::string successful6{ std::format("{}{}", "SELECT * FROM sink WHERE a < 3;",
+                                                    "SELECT (COUNT(*), MIN(b)) FROM sink WHERE a > 5;") };
+    std::string successful6_cleanup{ "DROP TABLE sink;" };
+    // a comma and the string NULL are quoted, the missing minimum is a bare NULL
+    const std::string successful6_csv{ "Script is valid.\n\n"
+                                       "a,b\n1,'one, two'\n2,'NULL'\n\n"
+                                       "COUNT(*),MIN(b)\n0,NULL\n\n" };
+    // column count, then type, name length and name per column, rows marked 1 with length-prefixed big-endian values,
+    // then 0 and the row count
+    const std::string successful6_binary{ "Script is valid.\n\n"
+        "\x00\x02" "\x00\x01" "a" "\x01\x01" "b"
+        "\x01" "\x04\x00\x00\x00\x01" "\x08" "one, two"
+        "\x01" "\x04\x00\x00\x00\x02" "\x04" "NULL"
+        "\x00" "\x00\x00\x00\x00\x00\x00\x00\x02"
+        "\x00\x02" "\x02\x08" "COUNT(*)" "\x03\x06" "MIN(b)"
+        "\x01" "\x08\x00\x00\x00\x00\x00\x00\x00\x00" "\x00"
+        "\x00" "\x00\x00\x00\x00\x00\x00\x00\x01"s };
+
+    // enough wide rows for leaf and internal page splits, inserted out of key order, 500 per statement
+    std::string successful7_setup{ "CREATE TABLE big (PRIMARY KEY VARCHAR k, NUMBER v, VARCHAR p, VARCHAR q, VARCHAR r);" };
+    std::string successful7_insert;
+    for(size_t i = 0; i < 6000; ++i){
+        const size_t key{ i * 3001 % 6000 };
+        successful7_insert += std::format("{}('k{:05}', {}, '{}', '{}', '{}'){}", i % 500 == 0 ? "INSERT INTO big (k, v, p, q, r) VALUES " : "",
+            key, key % 100, std::string(20, 'p'), std::string(20, 'q'), std::string(20, 'r'), i % 500 == 499 ? ";" : ", ");
+    }
+    // ranges span many leaves, the deleted keys too
+    std::string successful7{ std::format("{}{}{}{}{}{}{}", "SELECT (COUNT(*), MIN(k), MAX(k), MIN(v), MAX(v)) FROM big;",
+                                                      "SELECT (k, v) FROM big ORDER BY v LIMIT 3 OFFSET 60;",
+                                                      "SELECT COUNT(*) FROM big WHERE k >= 'k02950' AND k < 'k03050';",
+                                                      "DELETE FROM big WHERE k >= 'k01000' AND k < 'k01500';",
+                                                      "SELECT COUNT(*) FROM big;",
+                                                      "SELECT k FROM big WHERE k = 'k01499';",
+                                                      "SELECT (k, v) FROM big WHERE k = 'k01500' OR k = 'k00999';") };
+    const std::string successful7_output{ std::format("Script is valid.\n\n{}{}{}{}{}{}",
+        text_result({ "COUNT(*): 6000|MIN(k): k00000|MAX(k): k05999|MIN(v): 0|MAX(v): 99|" }),
+        text_result({ "k: k00001|v: 1|", "k: k00101|v: 1|", "k: k00201|v: 1|" }),
+        text_result({ "COUNT(*): 100|" }),
+        text_result({ "COUNT(*): 5500|" }),
+        text_result({}),
+        text_result({ "k: k00999|v: 99|", "k: k01500|v: 0|" })) };
+    // the table has far more leaves than the parts four threads split a scan into
+    std::string successful7_parallel{ std::format("{}{}{}", "SELECT (COUNT(*), SUM(v), MIN(k), MAX(v)) FROM big WHERE v > 10;",
+                                                             "SELECT COUNT(*) FROM big WHERE q = 'qqqqqqqqqqqqqqqqqqqq';",
+                                                             "SELECT k FROM big WHERE v = 7 LIMIT 3;") };
+    const std::string successful7_parallel_output{ std::format("Script is valid.\n\n{}{}{}",
+        text_result({ "COUNT(*): 4895|SUM(v): 269225|MIN(k): k00011|MAX(v): 99|" }),
+        text_result({ "COUNT(*): 5500|" }),
+        text_result({ "k: k00007|", "k: k00107|", "k: k00207|" })) };
+    std::string successful7_cleanup{ "DROP TABLE big;" };
+    // rows wide enough for two levels of internal pages over NUMBER keys, lookups descend through their packed prefixes
+    std::string successful8_columns;
+    for(size_t i = 0; i < 12; ++i){
+        successful8_columns += std::format(", VARCHAR c{}", i);
+    }
+    std::string successful8_setup{ std::format("CREATE TABLE nums (PRIMARY KEY NUMBER n{});", successful8_columns) };
+    std::string successful8_insert;
+    for(size_t i = 0; i < 6000; ++i){
+        successful8_insert += std::format("{}({}){}", i % 500 == 0 ? "INSERT INTO nums (n) VALUES " : "", i * 3001 % 6000 * 357913, i % 500 == 499 ? ";" : ", ");
+    }
+    std::string successful8{ std::format("{}{}{}{}{}", "SELECT (COUNT(*), MIN(n), MAX(n)) FROM nums;",
+                                                    "SELECT COUNT(*) FROM nums WHERE n >= 1073741824;",
+                                                    "SELECT n FROM nums WHERE n = 1073739000;",
+                                                    "SELECT n FROM nums WHERE n = 1073741824;",
+                                                    "SELECT COUNT(*) FROM nums WHERE n > 357913 AND n < 2147120087;") };
+    const std::string successful8_output{ std::format("Script is valid.\n\n{}{}{}{}{}",
+        text_result({ "COUNT(*): 6000|MIN(n): 0|MAX(n): 2147120087|" }),
+        text_result({ "COUNT(*): 2999|" }),
+        text_result({ "n: 1073739000|" }),
+        text_result({}),
+        text_result({ "COUNT(*): 5997|" })) };
+    std::string successful8_cleanup{ "DROP TABLE nums;" };
+    // ascending keys, alternately 250 in one statement and 250 statements of one row, then a few out of order
+    std::string successful9_setup{ "CREATE TABLE seq (PRIMARY KEY NUMBER n, VARCHAR s);" };
+    std::string successful9_insert;
+    for(size_t key = 10; key < 8010; key += 2){
+        const bool batch{ (key - 10) / 500 % 2 == 0 };
+        const bool first{ (key - 10) % 500 == 0 };
+        const bool last{ (key - 10) % 500 == 498 };
+        successful9_insert += std::format("{}({}, 'v{}'){}", !batch || first ? "INSERT INTO seq (n, s) VALUES " : "", key, key, !batch || last ? ";" : ", ");
+    }
+    std::string successful9{ std::format("{}{}{}{}{}{}", "INSERT INTO seq (n, s) VALUES (4001, 'v4001'), (5, 'v5');",
+                                                      "INSERT INTO seq (n, s) VALUES (9, 'v9');",
+                                                      "INSERT INTO seq (n, s) VALUES (4003, 'v4003');",
+                                                      "SELECT (COUNT(*), MIN(n), MAX(n)) FROM seq;",
+                                                      "SELECT n FROM seq LIMIT 3;",
+                                                      "SELECT (n, s) FROM seq WHERE n >= 3998 AND n <= 4006;") };
+    const std::string successful9_output{ std::format("Script is valid.\n\n{}{}{}",
+        text_result({ "COUNT(*): 4004|MIN(n): 5|MAX(n): 8008|" }),
+        text_result({ "n: 5|", "n: 9|", "n: 10|" }),
+        text_result({ "n: 3998|s: v3998|", "n: 4000|s: v4000|", "n: 4001|s: v4001|", "n: 4002|s: v4002|", "n: 4003|s: v4003|",
+            "n: 4004|s: v4004|", "n: 4006|s: v4006|" })) };
+    std::string successful9_cleanup{ "DROP TABLE seq;" };
+
+    std::string successful10_setup{ "CREATE TABLE conc (PRIMARY KEY NUMBER n, VARCHAR s);" };
+    std::string successful10{ std::format("{}{}", "SELECT (COUNT(*), MIN(n), MAX(n)) FROM conc;",
+                                                   "SELECT (n, s) FROM conc WHERE n >= 1998 AND n <= 2001;") };
+    const std::string successful10_output{ std::format("Script is valid.\n\n{}{}",
+        text_result({ "COUNT(*): 4000|MIN(n): 0|MAX(n): 3999|" }),
+        text_result({ "n: 1998|s: 1998|", "n: 1999|s: 1999|", "n: 2000|s: 2000|", "n: 2001|s: 2001|" })) };
+    std::string successful10_cleanup{ "DROP TABLE conc;" };
+    // with a one byte budget every row becomes a run of its own, 300 runs take two merge passes
+    std::string successful11_setup{ "CREATE TABLE runs (PRIMARY KEY NUMBER n, NUMBER g);" };
+    std::string successful11_insert{ "INSERT INTO runs (n, g) VALUES " };
+    for(size_t n = 0; n < 300; ++n){
+        successful11_insert += std::format("({}, {}){}", n, (299 - n) % 4, n + 1 < 300 ? ", " : ";");
+    }
+    std::string successful11{ std::format("{}{}", "SELECT n FROM runs ORDER BY g;",
+                                                   "SELECT (n, g) FROM runs ORDER BY g LIMIT 3 OFFSET 74;") };
+    // equal values keep their key order
+    std::vector<std::string> successful11_sorted;
+    for(size_t g = 0; g < 4; ++g){
+        for(size_t n = 0; n < 300; ++n){
+            if((299 - n) % 4 == g) successful11_sorted.push_back(std::format("n: {}|", n));
+        }
+    }
+    const std::string successful11_output{ std::format("Script is valid.\n\n{}{}", text_result(successful11_sorted),
+        text_result({ "n: 299|g: 0|", "n: 2|g: 1|", "n: 6|g: 1|" })) };
+    std::string successful11_cleanup{ "DROP TABLE runs;" };
+
+    // only the committed group is replayed, the rows logged after it have no commit record
+    std::string successful12_setup{ "CREATE TABLE replay (PRIMARY KEY NUMBER n, VARCHAR s);" };
+    std::string successful12{ std::format("{}{}", "SELECT (COUNT(*), MIN(n), MAX(n)) FROM replay;",
+                                                   "SELECT (n, s) FROM replay WHERE n >= 998;") };
+    const std::string successful12_output{ std::format("Script is valid.\n\n{}{}",
+        text_result({ "COUNT(*): 1000|MIN(n): 0|MAX(n): 999|" }),
+        text_result({ "n: 998|s: 998|", "n: 999|s: 999|" })) };
+    std::string successful12_cleanup{ "DROP TABLE replay;" };
 
     std::string lexical_err{ "SELECT abc FROM -" };
     std::string syntax_err{ "SELECT (a,b) WHERE a > 5;" };
     std::string semantic_err1{ "SELECT (a,b) FROM tab WHERE a > 'abc' ORDER BY a;" };
     std::string semantic_err2{ "CREATE TABLE tmp (VARCHAR A, VARCHAR B);"};
     std::string semantic_err3{ "CREATE TABLE tmp (PRIMARY KEY VARCHAR A, PRIMARY KEY VARCHAR B);"};
+    std::string semantic_err4{ "CREATE TABLE tmp (PRIMARY KEY VARCHAR A) PAGESIZE 1000;"};
+    std::string semantic_err5{ "COPY loaded FROM 'metadata/missing.csv';" };
+    std::string semantic_err6{ "COPY loaded FROM 'metadata/copy.csv' FILLFACTOR 5;" };
+    std::string semantic_err8{ "SELECT * FROM wide WHERE a > 1 AND c = 'b1';" };
+    std::string semantic_err9{ "CREATE INDEX widea ON wide(a);" };
+    std::string semantic_err10{ "SELECT (a, COUNT(*)) FROM wide;" };
+    std::string semantic_err11{ "SELECT SUM(b) FROM wide;" };
+    std::string semantic_err7{ "INSERT INTO wide (a,b) VALUES (6, 'b6'), (7);" };
 
     assert(mini_test(successful1) == Error::NO_ERR);
     assert(mini_test(successful2) == Error::NO_ERR);
     assert(mini_test(successful3_setup) == Error::NO_ERR);
-    assert(mini_test(successful3) == Error::NO_ERR);
+    assert(mini_test(successful3_index) == Error::NO_ERR);
+    const std::string buffered3{ mini_test_output(successful3) };
+    std::cout << buffered3;
+    assert(buffered3 == successful3_output);
+    assert(mini_test(successful3_drop_index) == Error::NO_ERR);
     assert(mini_test(successful3_cleanup) == Error::NO_ERR);
+    assert(mini_test(successful4_setup) == Error::NO_ERR);
+    const std::string buffered4{ mini_test_output(successful4) };
+    std::cout << buffered4;
+    assert(buffered4 == successful4_output);
+    assert(mini_test(semantic_err7) == Error::SEMANTIC_ERR);
+    assert(mini_test(semantic_err8) == Error::SEMANTIC_ERR);
+    assert(mini_test(semantic_err9) == Error::SEMANTIC_ERR);
+    assert(mini_test(semantic_err10) == Error::SEMANTIC_ERR);
+    assert(mini_test(semantic_err11) == Error::SEMANTIC_ERR);
+    assert(mini_test(successful4_cleanup) == Error::NO_ERR);
+#ifndef _WIN32
+    // memory-mapped table files answer the same scripts the same way
+    assert(mini_test(successful3_setup, StorageMode::MMAP) == Error::NO_ERR);
+    assert(mini_test(successful3_index, StorageMode::MMAP) == Error::NO_ERR);
+    assert(mini_test_output(successful3, StorageMode::MMAP) == buffered3);
+    assert(mini_test(successful3_drop_index, StorageMode::MMAP) == Error::NO_ERR);
+    assert(mini_test(successful3_cleanup, StorageMode::MMAP) == Error::NO_ERR);
+    assert(mini_test(successful4_setup, StorageMode::MMAP) == Error::NO_ERR);
+    assert(mini_test_output(successful4, StorageMode::MMAP) == buffered4);
+    assert(mini_test(successful4_cleanup, StorageMode::MMAP) == Error::NO_ERR);
+#endif
+    assert(mini_test(successful5_setup) == Error::NO_ERR);
+    assert(mini_test(successful5) == Error::NO_ERR);
+    assert(mini_test(semantic_err5) == Error::SEMANTIC_ERR);
+    assert(mini_test(semantic_err6) == Error::SEMANTIC_ERR);
+    assert(mini_test(successful5_cleanup) == Error::NO_ERR);
+    assert(mini_test(successful6_setup) == Error::NO_ERR);
+    assert(mini_test(successful6_insert) == Error::NO_ERR);
+    assert(mini_test_output(successful6, StorageMode::BUFFERED, OutputFormat::CSV) == successful6_csv);
+    assert(mini_test_output(successful6, StorageMode::BUFFERED, OutputFormat::BINARY) == successful6_binary);
+    assert(mini_test(successful6_cleanup) == Error::NO_ERR);
+    assert(mini_test(successful7_setup) == Error::NO_ERR);
+    assert(mini_test(successful7_insert) == Error::NO_ERR);
+    assert(mini_test_output(successful7) == successful7_output);
+    assert(mini_test_output(successful7_parallel, StorageMode::BUFFERED, OutputFormat::TEXT, 1) == successful7_parallel_output);
+    assert(mini_test_output(successful7_parallel, StorageMode::BUFFERED, OutputFormat::TEXT, 4) == successful7_parallel_output);
+    assert(mini_test(successful7_cleanup) == Error::NO_ERR);
+    assert(mini_test(successful8_setup) == Error::NO_ERR);
+    assert(mini_test(successful8_insert) == Error::NO_ERR);
+    assert(mini_test_output(successful8) == successful8_output);
+    assert(mini_test(successful8_cleanup) == Error::NO_ERR);
+    assert(mini_test(successful9_setup) == Error::NO_ERR);
+    assert(mini_test(successful9_insert) == Error::NO_ERR);
+    // appended leaves are split 90/10 and stay nearly full, half full ones would take over 55 pages
+    assert(std::filesystem::file_size(tables / "seq.db") <= 40 * PAGE_SIZE_);
+    assert(mini_test_output(successful9) == successful9_output);
+    assert(mini_test(successful9_cleanup) == Error::NO_ERR);
+    assert(mini_test(successful10_setup) == Error::NO_ERR);
+    assert(concurrent_insert("conc", 4000) == 4000);
+    assert(mini_test_output(successful10) == successful10_output);
+    assert(mini_test(successful10_cleanup) == Error::NO_ERR);
+    assert(mini_test(successful11_setup) == Error::NO_ERR);
+    assert(mini_test(successful11_insert) == Error::NO_ERR);
+    assert(mini_test_output(successful11, StorageMode::BUFFERED, OutputFormat::TEXT, 1, 1) == successful11_output);
+    assert(mini_test_output(successful11) == successful11_output);
+    // every run file is gone once the sorts are done
+    assert(std::filesystem::is_empty(base / "tmp"));
+    assert(mini_test(successful11_cleanup) == Error::NO_ERR);
+    assert(mini_test(successful12_setup) == Error::NO_ERR);
+    crash_after_commit("replay", 1000, 2000);
+    assert(mini_test_output(successful12) == successful12_output);
+    // replay wrote the rows back and emptied the log
+    assert(std::filesystem::file_size(wal / "wal.log") == 0);
+    assert(mini_test_output(successful12) == successful12_output);
+    assert(mini_test(successful12_cleanup) == Error::NO_ERR);
+
+    // every search the CPU supports counts the same keys, for arrays shorter and longer than a vector window
+    std::vector<int32_t> sorted_keys;
+    for(int32_t key = -300; key < 300; key += 3){
+        sorted_keys.insert(sorted_keys.end(), key % 2 == 0 ? 2 : 1, key);
+    }
+    const CountLess scalar{ count_less_for(KeySearchKind::SCALAR) };
+    for(size_t n = 0; n <= sorted_keys.size(); n += 5){
+        for(int32_t probe = -305; probe <= 305; ++probe){
+            const size_t expected{ scalar(sorted_keys.data(), n, probe) };
+            for(KeySearchKind kind : { KeySearchKind::BINARY, KeySearchKind::SSE2, KeySearchKind::AVX2 }){
+                const CountLess search{ count_less_for(kind) };
+                assert(search == nullptr || search(sorted_keys.data(), n, probe) == expected);
+            }
+            assert(count_less(sorted_keys.data(), n, probe) == expected);
+        }
+    }
     assert(mini_test(lexical_err) == Error::LEXICAL_ERR);
     assert(mini_test(syntax_err) == Error::SYNTAX_ERR);
     assert(mini_test(semantic_err1) == Error::SEMANTIC_ERR);
     assert(mini_test(semantic_err2) == Error::SEMANTIC_ERR);
     assert(mini_test(semantic_err3) == Error::SEMANTIC_ERR);
+    assert(mini_test(semantic_err4) == Error::SEMANTIC_ERR);
 
     return 0;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <format>
 #include <memory>
 #include <stdexcept>
+#include <utility>
 
 Parser::Parser(Lexer& lex) : lexer{ lex }, token_idx{ 0 } {} 
 
@@ -47,6 +48,8 @@ std::unique_ptr<ASTree> Parser::parse_query(){
             return parse_delete();
         case TokenType::DROP:
             return parse_drop();
+        case TokenType::COPY:
+            return parse_copy();
         default:
             throw std::runtime_error(std::format("Invalid query command: '{}'\n", token_type_str.at(token.token_type)));
     }
@@ -67,6 +70,9 @@ std::unique_ptr<ASTree> Parser::parse_select(){
     if(token.token_type == TokenType::ORDER){
         select_query->add_child(parse_orderby());
     }
+    if(token.token_type == TokenType::LIMIT){
+        select_query->add_child(parse_limit());
+    }
 
     consume_token(TokenType::SEMICOLON);
     return select_query;
@@ -75,15 +81,43 @@ std::unique_ptr<ASTree> Parser::parse_select(){
 std::unique_ptr<ASTree> Parser::parse_create(){
     std::unique_ptr<ASTree> create_query = std::make_unique<ASTree>(token, ASTNodeType::QUERY);
     consume_token(TokenType::CREATE);
+    if(token.token_type == TokenType::INDEX){
+        return parse_create_index(std::move(create_query));
+    }
     consume_token(TokenType::TABLE);
     
     create_query->add_child(parse_id());
     create_query->add_child(parse_table_columns());
+    if(token.token_type == TokenType::PAGESIZE){
+        consume_token(TokenType::PAGESIZE);
+        create_query->add_child(std::make_unique<ASTree>(token, ASTNodeType::PAGESIZE));
+        consume_token(TokenType::NUMBER_LITERAL);
+    }
     
     consume_token(TokenType::SEMICOLON);
     return create_query;
 }
 
+// CREATE INDEX name ON table (column)
+std::unique_ptr<ASTree> Parser::parse_create_index(std::unique_ptr<ASTree> create_query){
+    consume_token(TokenType::INDEX);
+    create_query->add_child(parse_index_name());
+    consume_token(TokenType::ON);
+    create_query->add_child(parse_id());
+    consume_token(TokenType::LPAREN);
+    create_query->add_child(parse_id());
+    consume_token(TokenType::RPAREN);
+
+    consume_token(TokenType::SEMICOLON);
+    return create_query;
+}
+
+std::unique_ptr<ASTree> Parser::parse_index_name(){
+    std::unique_ptr<ASTree> index = std::make_unique<ASTree>(token, ASTNodeType::INDEX);
+    consume_token(TokenType::ID);
+    return index;
+}
+
 std::unique_ptr<ASTree> Parser::parse_insert(){
     std::unique_ptr<ASTree> insert_query = std::make_unique<ASTree>(token, ASTNodeType::QUERY);
     consume_token(TokenType::INSERT);
@@ -91,7 +125,13 @@ std::unique_ptr<ASTree> Parser::parse_insert(){
     
     insert_query->add_child(parse_id());
     insert_query->add_child(parse_columns());
+
+    consume_token(TokenType::VALUES);
     insert_query->add_child(parse_values());
+    while(token.token_type == TokenType::COMMA){
+        consume_token(TokenType::COMMA);
+        insert_query->add_child(parse_values());
+    }
     
     consume_token(TokenType::SEMICOLON); 
     return insert_query;
@@ -132,29 +172,51 @@ std::unique_ptr<ASTree> Parser::parse_drop(){
     std::unique_ptr<ASTree> drop_query = std::make_unique<ASTree>(token, ASTNodeType::QUERY);
     consume_token(TokenType::DROP);
 
-    consume_token(TokenType::TABLE);
-    drop_query->add_child(parse_id());
+    if(token.token_type == TokenType::INDEX){
+        consume_token(TokenType::INDEX);
+        drop_query->add_child(parse_index_name());
+    }
+    else{
+        consume_token(TokenType::TABLE);
+        drop_query->add_child(parse_id());
+    }
 
     consume_token(TokenType::SEMICOLON);
     return drop_query;
 }
 
+std::unique_ptr<ASTree> Parser::parse_copy(){
+    std::unique_ptr<ASTree> copy_query = std::make_unique<ASTree>(token, ASTNodeType::QUERY);
+    consume_token(TokenType::COPY);
+    copy_query->add_child(parse_id());
+
+    consume_token(TokenType::FROM);
+    copy_query->add_child(std::make_unique<ASTree>(token, ASTNodeType::SOURCE));
+    consume_token(TokenType::STRING_LITERAL);
+    if(token.token_type == TokenType::FILLFACTOR){
+        consume_token(TokenType::FILLFACTOR);
+        copy_query->add_child(std::make_unique<ASTree>(token, ASTNodeType::FILLFACTOR));
+        consume_token(TokenType::NUMBER_LITERAL);
+    }
+
+    consume_token(TokenType::SEMICOLON);
+    return copy_query;
+}
+
 std::unique_ptr<ASTree> Parser::parse_select_columns(){
     std::unique_ptr<ASTree> columns = std::make_unique<ASTree>(Token{}, ASTNodeType::COLUMNS);
     if(token.token_type == TokenType::ASTERISK){
         columns->add_child(std::make_unique<ASTree>(token, ASTNodeType::COLUMN));
         consume_token(TokenType::ASTERISK);
     }
-    else if(token.token_type == TokenType::ID){
-        columns->add_child(std::make_unique<ASTree>(token, ASTNodeType::COLUMN));
-        consume_token(TokenType::ID);
+    else if(token.token_type != TokenType::LPAREN){
+        columns->add_child(parse_select_column());
     }
     else{
         consume_token(TokenType::LPAREN);
 
-        while(token.token_type == TokenType::ID){
-            columns->add_child(std::make_unique<ASTree>(token, ASTNodeType::COLUMN));
-            consume_token(TokenType::ID);
+        while(token.token_type == TokenType::ID || is_aggregate(token.token_type)){
+            columns->add_child(parse_select_column());
             if(token.token_type == TokenType::COMMA){
                 consume_token(TokenType::COMMA);
             }
@@ -167,6 +229,27 @@ std::unique_ptr<ASTree> Parser::parse_select_columns(){
     return columns;
 }
 
+// a column, or an aggregate of one, the AGGREGATE node is named after the call and holds its argument,
+// COUNT also takes *
+std::unique_ptr<ASTree> Parser::parse_select_column(){
+    if(!is_aggregate(token.token_type)){
+        std::unique_ptr<ASTree> column = std::make_unique<ASTree>(token, ASTNodeType::COLUMN);
+        consume_token(TokenType::ID);
+        return column;
+    }
+    const Token function{ token };
+    consume_token(function.token_type);
+    consume_token(TokenType::LPAREN);
+    const Token argument{ token };
+    consume_token(argument.token_type == TokenType::ASTERISK ? TokenType::ASTERISK : TokenType::ID);
+    consume_token(TokenType::RPAREN);
+
+    std::unique_ptr<ASTree> aggregate = std::make_unique<ASTree>(Token{ std::format("{}({})", function.value, argument.value), function.general_type, function.token_type },
+        ASTNodeType::AGGREGATE);
+    aggregate->add_child(std::make_unique<ASTree>(argument, ASTNodeType::COLUMN));
+    return aggregate;
+}
+
 std::unique_ptr<ASTree> Parser::parse_columns(){
     consume_token(TokenType::LPAREN);
     std::unique_ptr<ASTree> columns = std::make_unique<ASTree>(Token{}, ASTNodeType::COLUMNS);
@@ -185,18 +268,55 @@ std::unique_ptr<ASTree> Parser::parse_columns(){
     return columns;
 }
 
+// CONDITIONS holds a single CONDITION, which is a comparison or an AND/OR of two CONDITIONs
 std::unique_ptr<ASTree> Parser::parse_condition(){
     std::unique_ptr<ASTree> conditions = std::make_unique<ASTree>(token, ASTNodeType::CONDITIONS);
     consume_token(TokenType::WHERE);
-    
+    conditions->add_child(parse_or());
+
+    return conditions;
+}
+
+// AND binds tighter than OR, both group from the left
+std::unique_ptr<ASTree> Parser::parse_or(){
+    std::unique_ptr<ASTree> condition = parse_and();
+    while(token.token_type == TokenType::OR){
+        std::unique_ptr<ASTree> either = std::make_unique<ASTree>(token, ASTNodeType::CONDITION);
+        consume_token(TokenType::OR);
+        either->add_child(std::move(condition));
+        either->add_child(parse_and());
+        condition = std::move(either);
+    }
+    return condition;
+}
+
+std::unique_ptr<ASTree> Parser::parse_and(){
+    std::unique_ptr<ASTree> condition = parse_comparison();
+    while(token.token_type == TokenType::AND){
+        std::unique_ptr<ASTree> both = std::make_unique<ASTree>(token, ASTNodeType::CONDITION);
+        consume_token(TokenType::AND);
+        both->add_child(std::move(condition));
+        both->add_child(parse_comparison());
+        condition = std::move(both);
+    }
+    return condition;
+}
+
+std::unique_ptr<ASTree> Parser::parse_comparison(){
+    if(token.token_type == TokenType::LPAREN){
+        consume_token(TokenType::LPAREN);
+        std::unique_ptr<ASTree> condition = parse_or();
+        consume_token(TokenType::RPAREN);
+        return condition;
+    }
+
     std::unique_ptr<ASTree> lchild = token.general_type == GeneralTokenType::LITERAL ? parse_value() : parse_id();
     std::unique_ptr<ASTree> condition = std::make_unique<ASTree>(token, ASTNodeType::CONDITION);
     consume_token(token.general_type == GeneralTokenType::OPERATOR ? token.token_type : TokenType::NONE);
     condition->add_child(std::move(lchild));
     condition->add_child(token.general_type == GeneralTokenType::LITERAL ? parse_value() : parse_id());
-    conditions->add_child(std::move(condition));
 
-    return conditions;
+    return condition;
 }
 
 std::unique_ptr<ASTree> Parser::parse_orderby(){
@@ -209,6 +329,20 @@ std::unique_ptr<ASTree> Parser::parse_orderby(){
     return orderby;
 }
 
+// LIMIT n [OFFSET m]
+std::unique_ptr<ASTree> Parser::parse_limit(){
+    consume_token(TokenType::LIMIT);
+
+    std::unique_ptr<ASTree> limit = std::make_unique<ASTree>(token, ASTNodeType::LIMIT);
+    consume_token(TokenType::NUMBER_LITERAL);
+    if(token.token_type == TokenType::OFFSET){
+        consume_token(TokenType::OFFSET);
+        limit->add_child(std::make_unique<ASTree>(token, ASTNodeType::OFFSET));
+        consume_token(TokenType::NUMBER_LITERAL);
+    }
+    return limit;
+}
+
 std::unique_ptr<ASTree> Parser::parse_table_columns(){
     consume_token(TokenType::LPAREN);
 
@@ -242,7 +376,6 @@ std::unique_ptr<ASTree> Parser::parse_table_columns(){
 }
 
 std::unique_ptr<ASTree> Parser::parse_values(){
-    consume_token(TokenType::VALUES);
     consume_token(TokenType::LPAREN);
     std::unique_ptr<ASTree> values = std::make_unique<ASTree>(Token{}, ASTNodeType::VALUES);
     while(token.general_type == GeneralTokenType::LITERAL){
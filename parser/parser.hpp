@@ -26,19 +26,27 @@ private:
     std::unique_ptr<ASTree> parse_query();
     std::unique_ptr<ASTree> parse_select();
     std::unique_ptr<ASTree> parse_create();
+    std::unique_ptr<ASTree> parse_create_index(std::unique_ptr<ASTree>);
     std::unique_ptr<ASTree> parse_insert();
     std::unique_ptr<ASTree> parse_update();
     std::unique_ptr<ASTree> parse_delete();
     std::unique_ptr<ASTree> parse_drop();
+    std::unique_ptr<ASTree> parse_copy();
 
     std::unique_ptr<ASTree> parse_select_columns();
+    std::unique_ptr<ASTree> parse_select_column();
     std::unique_ptr<ASTree> parse_columns();
     std::unique_ptr<ASTree> parse_condition();
+    std::unique_ptr<ASTree> parse_or();
+    std::unique_ptr<ASTree> parse_and();
+    std::unique_ptr<ASTree> parse_comparison();
     std::unique_ptr<ASTree> parse_orderby();
+    std::unique_ptr<ASTree> parse_limit();
     std::unique_ptr<ASTree> parse_table_columns();
     std::unique_ptr<ASTree> parse_values();
     std::unique_ptr<ASTree> parse_assignments();
     std::unique_ptr<ASTree> parse_id();
+    std::unique_ptr<ASTree> parse_index_name();
     std::unique_ptr<ASTree> parse_value();
 
 };
@@ -0,0 +1,131 @@
+#include "planner.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "../storage/storage/page.hpp"
+
+namespace {
+
+// NUMBER keys are big-endian and VARCHAR keys zero-padded, so stored keys order like their bytes
+std::vector<char> encode_key(const Column& key_column, const std::string& literal) {
+    std::vector<char> key(column_size(key_column.type, true), 0);
+    if(key_column.type == DataType::NUMBER){
+        uint32_t number{ static_cast<uint32_t>(std::stoul(literal)) };
+        if constexpr(std::endian::native == std::endian::little){
+            number = std::byteswap(number);
+        }
+        std::memcpy(key.data(), &number, sizeof(number));
+    }
+    else{
+        std::memcpy(key.data(), literal.data(), std::min(literal.size(), key.size() - 1));
+    }
+    return key;
+}
+
+// keeps the tighter of two lower bounds, or of two upper bounds when upper is set
+void tighten(std::vector<char>& bound, bool& inclusive, std::vector<char> key, bool key_inclusive, bool upper) {
+    if(!bound.empty()){
+        int order{ std::memcmp(key.data(), bound.data(), key.size()) };
+        if(upper) order = -order;
+        if(order < 0 || (order == 0 && (key_inclusive || !inclusive))) return;
+    }
+    bound = std::move(key);
+    inclusive = key_inclusive;
+}
+
+bool bounded(const AccessPath& access_path) noexcept {
+    return !access_path.lower.empty() || !access_path.upper.empty();
+}
+
+}
+
+Planner::Planner(const SchemaCatalog& schema_catalog) : schema_catalog{ schema_catalog } {}
+
+AccessPath Planner::plan(const ASTree* query) const {
+    const bool select{ query->get_token().token_type == TokenType::SELECT };
+    const size_t table{ select ? 1u : 0u };
+    AccessPath access_path{};
+    auto table_schema = schema_catalog.get_table(query->child_at(table)->get_token().value);
+    if(!table_schema.has_value() || query->children_size() <= table + 1 || query->child_at(table + 1)->get_type() != ASTNodeType::CONDITIONS){
+        return access_path;
+    }
+
+    // the primary key first, then the indexes in the order they were created
+    const ASTree* condition{ query->child_at(table + 1)->child_at(0) };
+    const Column& key_column{ table_schema->get().get_key_column() };
+    plan_condition(key_column, condition, access_path);
+    if(bounded(access_path)){
+        const bool point{ access_path.lower == access_path.upper && access_path.lower_inclusive && access_path.upper_inclusive };
+        access_path.method = point ? AccessMethod::POINT_LOOKUP : AccessMethod::RANGE_SCAN;
+        return access_path;
+    }
+    for(const auto& index : table_schema->get().get_indexes()){
+        plan_condition(table_schema->get().get_column(index.column)->get(), condition, access_path);
+        if(bounded(access_path)){
+            access_path.method = AccessMethod::INDEX_SCAN;
+            access_path.index = index.name;
+            return access_path;
+        }
+    }
+    return access_path;
+}
+
+// only the operands of AND have to hold for every matching row, an OR can't narrow the range
+void Planner::plan_condition(const Column& column, const ASTree* condition, AccessPath& access_path) const {
+    switch(condition->get_token().token_type){
+        case TokenType::AND:
+            plan_condition(column, condition->child_at(0), access_path);
+            plan_condition(column, condition->child_at(1), access_path);
+            break;
+        case TokenType::OR:
+            break;
+        default:
+            plan_comparison(column, condition, access_path);
+            break;
+    }
+}
+
+// bounds the column, which is stored like a key either in the table or in one of its indexes
+void Planner::plan_comparison(const Column& key_column, const ASTree* comparison, AccessPath& access_path) const {
+    const ASTree* left = comparison->child_at(0);
+    const ASTree* right = comparison->child_at(1);
+    const bool key_left{ left->get_type() == ASTNodeType::ID && left->get_token().value == key_column.name && right->get_type() != ASTNodeType::ID };
+    const bool key_right{ right->get_type() == ASTNodeType::ID && right->get_token().value == key_column.name && left->get_type() != ASTNodeType::ID };
+    if(!key_left && !key_right) return;
+
+    // 5 < id bounds the key like id > 5
+    TokenType op{ comparison->get_token().token_type };
+    if(key_right){
+        std::swap(left, right);
+        switch(op){
+            case TokenType::LESS: op = TokenType::GREATER; break;
+            case TokenType::LESS_EQUAL: op = TokenType::GREATER_EQUAL; break;
+            case TokenType::GREATER: op = TokenType::LESS; break;
+            case TokenType::GREATER_EQUAL: op = TokenType::LESS_EQUAL; break;
+            default: break;
+        }
+    }
+
+    const std::vector<char> key{ encode_key(key_column, right->get_token().value) };
+    switch(op){
+        case TokenType::EQUAL:
+            tighten(access_path.lower, access_path.lower_inclusive, key, true, false);
+            tighten(access_path.upper, access_path.upper_inclusive, key, true, true);
+            break;
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+            tighten(access_path.lower, access_path.lower_inclusive, key, op == TokenType::GREATER_EQUAL, false);
+            break;
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+            tighten(access_path.upper, access_path.upper_inclusive, key, op == TokenType::LESS_EQUAL, true);
+            break;
+        default:
+            break;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef PLANNER_HPP
+#define PLANNER_HPP
+
+#include <string>
+#include <vector>
+
+#include "../ASTree/ASTree.hpp"
+#include "../SchemaCatalog/SchemaCatalog/SchemaCatalog.hpp"
+
+enum class AccessMethod { FULL_SCAN, POINT_LOOKUP, RANGE_SCAN, INDEX_SCAN };
+
+// bounds on the primary key in its stored form, or on the indexed column for an index scan,
+// an empty bound leaves that end of the range open, rows inside the range still have to pass the whole condition
+struct AccessPath {
+    AccessMethod method{ AccessMethod::FULL_SCAN };
+    std::vector<char> lower;
+    std::vector<char> upper;
+    bool lower_inclusive{ true };
+    bool upper_inclusive{ true };
+    std::string index;      // index scans only
+    std::vector<char> keys; // primary keys the index produced, filled in before the table is read
+};
+
+// picks how a SELECT or DELETE reaches its rows, comparisons of the key or of an indexed column with a literal
+// that every matching row has to satisfy narrow the part of the tree that is read
+class Planner{
+public:
+    Planner(const SchemaCatalog&);
+
+    AccessPath plan(const ASTree*) const;
+
+private:
+    const SchemaCatalog& schema_catalog;
+
+    void plan_condition(const Column&, const ASTree*, AccessPath&) const;
+    void plan_comparison(const Column&, const ASTree*, AccessPath&) const;
+
+};
+
+#endif
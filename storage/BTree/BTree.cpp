@@ -1,190 +1,575 @@
 #include "BTree.hpp"
 
+#include <algorithm>
+#include <bit>
 #include <cstring>
 #include <iostream>
 #include <string>
 
-void BTree::split(TablePage* x, int i, TablePage* y, const std::string& table_path, BufferManager& buffer_manager) {
-    std::unique_ptr<TablePage> z = std::make_unique<TablePage>(TablePage{ y->is_leaf });
-    z->n = T - 1;
-    z->page_id = buffer_manager.new_page_id(table_path);
+namespace {
 
-    for(int j = 0; j < static_cast<int>(T) - 1; ++j) {
-        std::memcpy(&z->blocks[j], &y->blocks[T + j], sizeof(Block));
+// NUMBER keys are stored big-endian, loaded as integers they compare in numeric order
+int compare_number(const char* lhs, const char* rhs) noexcept {
+    uint32_t a, b;
+    std::memcpy(&a, lhs, sizeof(a));
+    std::memcpy(&b, rhs, sizeof(b));
+    if constexpr(std::endian::native == std::endian::little){
+        a = std::byteswap(a);
+        b = std::byteswap(b);
     }
-    if(y->is_leaf == 0) {
-        for(int j = 0; j < static_cast<int>(T); ++j) {
-            z->children[j] = y->children[T + j];
+    return (a > b) - (a < b);
+}
+
+// VARCHAR keys are zero-padded to MAX_KEY_SIZE, so bytes past the terminator never decide the order
+int compare_varchar(const char* lhs, const char* rhs) noexcept {
+    return std::memcmp(lhs, rhs, MAX_KEY_SIZE);
+}
+
+}
+
+template<size_t PageSize>
+BTree<PageSize>::BTree(const TableSchema& table_schema) : key_size{ table_schema.get_key_size() }, record_size{ table_schema.get_record_size() },
+    key_compare{ table_schema.get_key_column().type == DataType::NUMBER ? compare_number : compare_varchar } {}
+
+template<size_t PageSize>
+int BTree<PageSize>::compare(const char* key, const char* record) const noexcept {
+    return key_compare(key, record);
+}
+
+template<size_t PageSize>
+bool BTree<PageSize>::is_full(const Page& page) const noexcept {
+    return page.is_leaf ? !page.fits(record_size) : page.n >= page.capacity();
+}
+
+// binary search in [low, high) for the first key greater than key, or not less than it unless upper
+template<size_t PageSize>
+size_t BTree<PageSize>::bound(const Page& page, const char* key, size_t low, size_t high, bool upper) const noexcept {
+    while(low < high) {
+        const size_t mid{ low + (high - low) / 2 };
+        const int order{ compare(key, page.key_at(mid)) };
+        if(order > 0 || (upper && order == 0)) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
         }
     }
-    y->n = T - 1;
+    return low;
+}
 
-    for(int j = x->n; j >= i + 1; --j) {
-        x->children[j + 1] = x->children[j];
-    }
-    x->children[i + 1] = z->page_id;
+// internal pages narrow the range with their prefix array first, whole keys only break ties between equal prefixes
+template<size_t PageSize>
+size_t BTree<PageSize>::upper_bound(const Page& page, const char* key) const noexcept {
+    if(page.is_leaf) return bound(page, key, 0, page.n, true);
 
-    for(int j = x->n - 1; j >= i; --j){
-        std::memcpy(&x->blocks[j + 1], &x->blocks[j], sizeof(Block));
-    }
-    std::memcpy(&x->blocks[i], &y->blocks[T - 1], sizeof(Block));
-    ++x->n;
+    const int32_t prefix{ Page::key_prefix(key, key_size) };
+    const size_t high{ prefix == INT32_MAX ? page.n : count_less(page.prefixes(), page.n, prefix + 1) };
+    if(key_size <= sizeof(int32_t)) return high;
+    return bound(page, key, count_less(page.prefixes(), high, prefix), high, true);
+}
 
-    buffer_manager.write_page(table_path, x);
-    buffer_manager.write_page(table_path, y);
-    buffer_manager.write_page(table_path, z.get());
+template<size_t PageSize>
+size_t BTree<PageSize>::lower_bound(const Page& page, const char* key) const noexcept {
+    if(page.is_leaf) return bound(page, key, 0, page.n, false);
+
+    const int32_t prefix{ Page::key_prefix(key, key_size) };
+    const size_t low{ count_less(page.prefixes(), page.n, prefix) };
+    if(key_size <= sizeof(int32_t)) return low;
+    const size_t high{ prefix == INT32_MAX ? page.n : low + count_less(page.prefixes() + low, page.n - low, prefix + 1) };
+    return bound(page, key, low, high, false);
 }
 
-void BTree::insert_nonfull(std::unique_ptr<TablePage>&& page, Block& block, const std::string& table_path, BufferManager& buffer_manager){
-    int i = page->n - 1;
+// a leaf keeps the cells before mid and the first key of its new right sibling is copied up,
+// an internal page moves key mid up and keeps neither half of it
+template<size_t PageSize>
+void BTree<PageSize>::split(Handle& x, size_t i, Handle& y, size_t mid, const std::string& table_path, BufferManager& buffer_manager) {
+    Handle z = buffer_manager.new_page<PageSize>(table_path, y->is_leaf, key_size);
 
-    if(page->is_leaf == 1) {
-        while(i >= 0 && std::strcmp(block.key, page->blocks[i].key) < 0) {
-            std::memcpy(&page->blocks[i+1], &page->blocks[i], sizeof(Block));
-            --i;
+    if(y->is_leaf) {
+        for(size_t j = mid; j < y->n; ++j) {
+            const Slot& slot = y->slot_at(j);
+            std::memcpy(z->insert_cell(z->n, slot.size), y->cell_at(j), slot.size);
         }
-        std::memcpy(&page->blocks[i + 1], &block, sizeof(Block));
-        ++page->n;
-        buffer_manager.write_page(table_path, page.get());
+        x->insert_entry(i, y->page_id, z->key_at(0));
+        z->next_leaf = y->next_leaf;
+        y->next_leaf = z->page_id;
     }
     else {
-        while(i >= 0 && std::strcmp(block.key, page->blocks[i].key) < 0) {
-            --i;
+        for(size_t j = mid + 1; j < y->n; ++j) {
+            z->insert_entry(z->n, y->child_at(j), y->key_at(j));
+        }
+        x->insert_entry(i, y->page_id, y->key_at(mid));
+        z->right_child = y->right_child;
+        y->right_child = y->child_at(mid);
+    }
+    x->set_child(i + 1, z->page_id);
+
+    y->truncate(mid);
+
+    x.mark_dirty();
+    y.mark_dirty();
+    z.mark_dirty();
+}
+
+// halves a page, unless it is the last one on its level and key goes past its end, as it does for ever increasing
+// keys, then nine tenths stay behind so that pages left of the insertion point end up nearly full
+template<size_t PageSize>
+size_t BTree<PageSize>::split_point(const Page& page, const char* key, bool rightmost) const noexcept {
+    if(rightmost && compare(key, page.key_at(page.n - 1u)) >= 0) {
+        return std::clamp<size_t>(page.n * 9u / 10u, 1, page.n - 1u);
+    }
+    return page.n / 2u;
+}
+
+// the remembered last leaf takes key without a descent when key sorts after everything in the table
+template<size_t PageSize>
+typename BTree<PageSize>::Handle BTree<PageSize>::rightmost_leaf_for(const char* key, const std::string& table_path, BufferManager& buffer_manager) {
+    const uint32_t page_id{ buffer_manager.get_rightmost_leaf(table_path) };
+    if(page_id == NO_PAGE) return Handle{};
+
+    Handle leaf = buffer_manager.table_page_at<PageSize>(table_path, page_id, PageAccess::WRITE);
+    if(!leaf || leaf->is_leaf == 0 || leaf->next_leaf != NO_PAGE || leaf->n == 0 || is_full(*leaf) || compare(key, leaf->key_at(leaf->n - 1u)) < 0) {
+        return Handle{};
+    }
+    return leaf;
+}
+
+// most inserts leave the pages above the leaf alone, so the descent only latches them shared and the leaf exclusively,
+// the parent stays latched until then so nobody can split the leaf in between, no leaf comes back when it is full
+// or the root is a leaf, fence as for leaf_for_insert
+template<size_t PageSize>
+typename BTree<PageSize>::Handle BTree<PageSize>::optimistic_leaf_for(const char* key, const std::string& table_path, BufferManager& buffer_manager,
+    std::vector<char>& fence) {
+    Handle page = buffer_manager.root_table_page<PageSize>(table_path, PageAccess::READ);
+    if(!page || page->is_leaf) return Handle{};
+
+    for(;;) {
+        const size_t i = upper_bound(*page, key);
+        if(i < page->n) {
+            fence.assign(page->key_at(i), page->key_at(i) + key_size);
         }
-        ++i;
-        std::unique_ptr<TablePage> page_i = buffer_manager.table_page_at(table_path, page->children[i]);
+        const uint32_t child_id{ page->child_at(i) };
+        Handle child = buffer_manager.table_page_at<PageSize>(table_path, child_id, PageAccess::READ);
+        if(!child) return child;
+        if(child->is_leaf == 0) {
+            page = std::move(child);
+            continue;
+        }
+        child.release();
+        child = buffer_manager.table_page_at<PageSize>(table_path, child_id, PageAccess::WRITE);
+        if(!child || is_full(*child)) return Handle{};
+        if(child->next_leaf == NO_PAGE) {
+            buffer_manager.set_rightmost_leaf(table_path, child_id);
+        }
+        return child;
+    }
+}
+
+// descends to the leaf key belongs in and splits every full page on the way, so the leaf has room for one more
+// record, fence receives the separator bounding the leaf from above and stays empty for the rightmost leaf,
+// every page on the way has room once it is reached, so only it and its parent are latched at a time and
+// the root latch is only held until the root is known not to split
+template<size_t PageSize>
+typename BTree<PageSize>::Handle BTree<PageSize>::leaf_for_insert(const char* key, const std::string& table_path, BufferManager& buffer_manager, std::vector<char>& fence) {
+    fence.clear();
+    if(Handle leaf = rightmost_leaf_for(key, table_path, buffer_manager)) {
+        return leaf;
+    }
+    if(Handle leaf = optimistic_leaf_for(key, table_path, buffer_manager, fence)) {
+        return leaf;
+    }
+    fence.clear();
 
-        if(page_i->n == 2 * T - 1) {
-            split(page.get(), i, page_i.get(), table_path, buffer_manager);
-            if(std::strcmp(block.key,page->blocks[i].key) > 0) {
+    std::unique_lock root_guard{ buffer_manager.root_latch(table_path) };
+    Handle page = buffer_manager.table_page_at<PageSize>(table_path, buffer_manager.get_root_id(table_path), PageAccess::WRITE);
+    if(!page) return page;
+
+    if(is_full(*page)){
+        Handle s = buffer_manager.new_page<PageSize>(table_path, 0, key_size);
+
+        s->right_child = page->page_id;
+        buffer_manager.update_root_id(table_path, s->page_id);
+        s.mark_dirty();
+
+        split(s, 0, page, split_point(*page, key, true), table_path, buffer_manager);
+        page = std::move(s);
+    }
+    root_guard.unlock();
+
+    while(page->is_leaf == 0) {
+        size_t i = upper_bound(*page, key);
+        Handle child = buffer_manager.table_page_at<PageSize>(table_path, page->child_at(i), PageAccess::WRITE);
+
+        if(is_full(*child)) {
+            split(page, i, child, split_point(*child, key, fence.empty() && i == page->n), table_path, buffer_manager);
+            if(compare(key, page->key_at(i)) >= 0) {
                 ++i;
-                page_i = buffer_manager.table_page_at(table_path, page->children[i]);
+                child = buffer_manager.table_page_at<PageSize>(table_path, page->child_at(i), PageAccess::WRITE);
             }
         }
-        insert_nonfull(std::move(page_i), block, table_path, buffer_manager);
+        if(i < page->n) {
+            fence.assign(page->key_at(i), page->key_at(i) + key_size);
+        }
+        page = std::move(child);
+    }
+    if(page->next_leaf == NO_PAGE) {
+        buffer_manager.set_rightmost_leaf(table_path, page->page_id);
     }
+    return page;
 }
 
-std::unique_ptr<Block> BTree::search(std::unique_ptr<TablePage> page, char* key, const std::string& table_path, BufferManager& buffer_manager) {
-    uint32_t i = 0;
-    while(i < page->n && std::strcmp(key, page->blocks[i].key) > 0) {
-        ++i;
+// leaf holding the first record whose key is not less than key, or the leaf before it
+template<size_t PageSize>
+typename BTree<PageSize>::Handle BTree<PageSize>::find_leaf(const char* key, const std::string& table_path, BufferManager& buffer_manager) {
+    Handle page = buffer_manager.root_table_page<PageSize>(table_path, PageAccess::READ);
+    while(page && page->is_leaf == 0) {
+        page = buffer_manager.table_page_at<PageSize>(table_path, page->child_at(lower_bound(*page, key)), PageAccess::READ);
     }
-    if(i < page->n && std::strcmp(key, page->blocks[i].key) == 0){
-        return std::make_unique<Block>(page->blocks[i]);
+    return page;
+}
+
+template<size_t PageSize>
+typename BTree<PageSize>::Handle BTree<PageSize>::first_leaf(const std::string& table_path, BufferManager& buffer_manager) {
+    Handle page = buffer_manager.root_table_page<PageSize>(table_path, PageAccess::READ);
+    while(page && page->is_leaf == 0) {
+        page = buffer_manager.table_page_at<PageSize>(table_path, page->child_at(0), PageAccess::READ);
     }
-    else if(page->is_leaf) {
-        return nullptr;
+    return page;
+}
+
+template<size_t PageSize>
+void BTree<PageSize>::insert(const std::vector<char>& record, BufferManager& buffer_manager, const std::string& table_path) {
+    std::vector<char> fence;
+    Handle leaf = leaf_for_insert(record.data(), table_path, buffer_manager, fence);
+    if(!leaf) return;
+
+    std::memcpy(leaf->insert_cell(upper_bound(*leaf, record.data()), record_size), record.data(), record_size);
+    leaf.mark_dirty();
+}
+
+// records are sorted first, one descent then places every following record that still belongs in the same leaf
+// and fits into it
+template<size_t PageSize>
+void BTree<PageSize>::insert_batch(const std::vector<std::vector<char>>& records, BufferManager& buffer_manager, const std::string& table_path) {
+    std::vector<const char*> sorted(records.size());
+    std::transform(records.begin(), records.end(), sorted.begin(), [](const auto& record){ return record.data(); });
+    std::stable_sort(sorted.begin(), sorted.end(), [this](const char* a, const char* b){ return compare(a, b) < 0; });
+
+    std::vector<char> fence;
+    for(size_t next = 0; next < sorted.size(); ) {
+        Handle leaf = leaf_for_insert(sorted[next], table_path, buffer_manager, fence);
+        if(!leaf) return;
+
+        do {
+            const char* record = sorted[next++];
+            std::memcpy(leaf->insert_cell(upper_bound(*leaf, record), record_size), record, record_size);
+        } while(next < sorted.size() && !is_full(*leaf) && (fence.empty() || compare(sorted[next], fence.data()) < 0));
+        leaf.mark_dirty();
     }
-    std::unique_ptr<TablePage> page_i = buffer_manager.table_page_at(table_path, page->children[i]);
-    return search(std::move(page_i), key, table_path, buffer_manager);
 }
 
-void BTree::insert(Block& block, BufferManager& buffer_manager, const std::string& table_path) {
-    std::unique_ptr<TablePage> root = buffer_manager.root_table_page(table_path);
-    if(root == nullptr) return;
+// records are packed back to back, they are sorted unless they already are, merged with the rows the table
+// holds and written out as a new tree, equal keys keep the rows already in the table first
+template<size_t PageSize>
+void BTree<PageSize>::bulk_load(const std::vector<char>& records, BufferManager& buffer_manager, const std::string& table_path, size_t fill_factor) {
+    auto less = [this](const char* a, const char* b){ return compare(a, b) < 0; };
 
-    if(root->n == 2 * T - 1){
-        std::unique_ptr<TablePage> s = std::make_unique<TablePage>(TablePage{ 0 });
-        s->page_id = buffer_manager.new_page_id(table_path);
+    std::vector<const char*> loaded;
+    loaded.reserve(records.size() / record_size);
+    for(size_t offset = 0; offset < records.size(); offset += record_size){
+        loaded.push_back(records.data() + offset);
+    }
+    if(!std::is_sorted(loaded.begin(), loaded.end(), less)){
+        std::stable_sort(loaded.begin(), loaded.end(), less);
+    }
 
-        if(s->page_id == 0){
-            return;
+    std::vector<char> stored;
+    for(Handle page = first_leaf(table_path, buffer_manager); page; ){
+        for(size_t i = 0; i < page->n; ++i){
+            stored.insert(stored.end(), page->record_at(i), page->record_at(i) + record_size);
         }
+        if(page->next_leaf == NO_PAGE) break;
+        page = buffer_manager.table_page_at<PageSize>(table_path, page->next_leaf, PageAccess::READ);
+    }
 
-        s->children[0] = root->page_id;
-        buffer_manager.update_root_id(table_path, s->page_id);
-        buffer_manager.write_page(table_path, s.get());
-
-        split(s.get(), 0, root.get(), table_path, buffer_manager);
-        insert_nonfull(std::move(s), block, table_path, buffer_manager);
+    std::vector<const char*> merged;
+    merged.reserve(stored.size() / record_size + loaded.size());
+    size_t offset{ 0 };
+    for(const char* record : loaded){
+        for(; offset < stored.size() && !less(record, stored.data() + offset); offset += record_size){
+            merged.push_back(stored.data() + offset);
+        }
+        merged.push_back(record);
     }
-    else{
-        insert_nonfull(std::move(root), block, table_path, buffer_manager);
+    for(; offset < stored.size(); offset += record_size){
+        merged.push_back(stored.data() + offset);
     }
+    buffer_manager.rebuild_table(table_path, merged, record_size, key_size, fill_factor);
 }
 
-std::unique_ptr<Block> BTree::search(char* key, const std::string& table_path, BufferManager& buffer_manager) {
-    std::unique_ptr<TablePage> root_page = buffer_manager.root_table_page(table_path);
-    return search(std::move(root_page), key, table_path, buffer_manager);
+// equal keys may straddle a split, so the search continues into the next leaf when it runs off the end
+template<size_t PageSize>
+std::optional<std::vector<char>> BTree<PageSize>::search(const char* key, const std::string& table_path, BufferManager& buffer_manager) {
+    Handle page = find_leaf(key, table_path, buffer_manager);
+    while(page) {
+        const size_t i = lower_bound(*page, key);
+        if(i < page->n) {
+            if(compare(key, page->key_at(i)) != 0) return std::nullopt;
+            return std::vector<char>{ page->record_at(i), page->record_at(i) + record_size };
+        }
+        if(page->next_leaf == NO_PAGE) break;
+        page = buffer_manager.table_page_at<PageSize>(table_path, page->next_leaf, PageAccess::READ);
+    }
+    return std::nullopt;
 }
 
-void BTree::traverse(const std::string& table_path, uint32_t page_id, BufferManager& buffer_manager, const TableSchema& table_schema, int padding){
-    auto page = buffer_manager.table_page_at(table_path, page_id);
+template<size_t PageSize>
+void BTree<PageSize>::traverse(const std::string& table_path, uint32_t page_id, BufferManager& buffer_manager, const TableSchema& table_schema, int padding){
+    auto page = buffer_manager.table_page_at<PageSize>(table_path, page_id, PageAccess::READ);
     std::cout << std::format("{}Page ID: {}, n: {}\n", std::string(padding * 4, ' '), page->page_id, page->n);
-    for(uint8_t i = 0; i < page->n; ++i){
-        std::cout << std::format("{}Key: {}\n", std::string(padding * 4, ' '), page->blocks[i].key);
-        auto data = buffer_manager.block_to_data(page->blocks[i], table_schema);
-        for(const Column& col : table_schema.get_columns()){
-            std::visit([&](const auto& val) {
-                std::cout << std::format("{}{}: {}\n", std::string(padding * 4, ' '), col.name, val);
-            }, data[col.name]);
+    if(page->is_leaf == 0){
+        for(size_t i = 0; i < page->n + 1u; ++i){
+            traverse(table_path, page->child_at(i), buffer_manager, table_schema, padding + 1);
         }
+        return;
     }
-    if(page->is_leaf == 0){
-        for(uint8_t i = 0; i < page->n + 1; ++i){
-            traverse(table_path, page->children[i], buffer_manager, table_schema, padding + 1);
+    const size_t key{ table_schema.get_column_index(table_schema.get_key_column().name) };
+    auto print = [&](const std::string& name, const RowView& row, size_t column){
+        if(table_schema.get_column_at(column).type == DataType::VARCHAR){
+            std::cout << std::format("{}{}: {}\n", std::string(padding * 4, ' '), name, row.string(column));
+        }
+        else{
+            std::cout << std::format("{}{}: {}\n", std::string(padding * 4, ' '), name, row.number(column));
+        }
+    };
+    for(size_t i = 0; i < page->n; ++i){
+        const RowView row{ table_schema, page->record_at(i) };
+        print("Key", row, key);
+        for(size_t column = 0; column < table_schema.columns_size(); ++column){
+            print(table_schema.get_column_at(column).name, row, column);
         }
     }
 }
 
-void BTree::traverse(const std::string& table_path, BufferManager& buffer_manager, const TableSchema& table_schema){
+template<size_t PageSize>
+void BTree<PageSize>::traverse(const std::string& table_path, BufferManager& buffer_manager, const TableSchema& table_schema){
     traverse(table_path, buffer_manager.get_root_id(table_path), buffer_manager, table_schema, 0);
 }
 
-void BTree::del(const std::string& table_path, BufferManager& buffer_manager, const TableSchema& table_schema, const ASTree* _delete){
+template<size_t PageSize>
+std::vector<char> BTree<PageSize>::del(const std::string& table_path, BufferManager& buffer_manager, const TableSchema& table_schema, const ASTree* _delete,
+    const AccessPath& access_path){
     if(_delete->children_size() == 1){
         buffer_manager.delete_all_data(table_path);
+        return {};
     }
-    else{
-        del_blocks(table_path, buffer_manager, table_schema, _delete->child_at(1));
+    return del_records(table_path, buffer_manager, table_schema, _delete->child_at(1), access_path);
+}
+
+// rows are removed from their leaves in place, pages are neither merged nor freed, so separators above them
+// still bound their key ranges, the removed records are handed back
+template<size_t PageSize>
+std::vector<char> BTree<PageSize>::del_records(const std::string& table_path, BufferManager& buffer_manager, const TableSchema& table_schema, const ASTree* conditions,
+    const AccessPath& access_path){
+    const Predicate predicate{ conditions, table_schema };
+    std::vector<char> removed;
+    auto remove = [this, &predicate, &removed](const char* record){
+        if(!predicate.matches(record)) return true;
+        removed.insert(removed.end(), record, record + record_size);
+        return false;
+    };
+
+    for(const AccessPath& range : ranges(access_path)){
+        size_t first;
+        Handle leaf = seek(range, table_path, buffer_manager, first);
+        if(!leaf) continue;
+        const uint32_t page_id{ leaf->page_id };
+        leaf.release();
+
+        // a split between the two latches only moves records to the right, where the walk still goes
+        Handle page = buffer_manager.table_page_at<PageSize>(table_path, page_id, PageAccess::WRITE);
+        while(page){
+            const bool last{ page->n > 0 && past_upper(range, page->key_at(page->n - 1u)) };
+            if(page->retain(remove) > 0){
+                page.mark_dirty();
+            }
+            if(last || page->next_leaf == NO_PAGE) break;
+            page = buffer_manager.table_page_at<PageSize>(table_path, page->next_leaf, PageAccess::WRITE);
+        }
     }
+    return removed;
 }
 
-//TODO deletion with condition
-void BTree::del_blocks(const std::string&, BufferManager&, const TableSchema&, const ASTree*){
+// removes one record that equals the given one byte for byte, records with an equal key may span several leaves
+template<size_t PageSize>
+bool BTree<PageSize>::erase(const char* record, const std::string& table_path, BufferManager& buffer_manager) {
+    Handle leaf = find_leaf(record, table_path, buffer_manager);
+    if(!leaf) return false;
+    const uint32_t page_id{ leaf->page_id };
+    leaf.release();
 
+    Handle page = buffer_manager.table_page_at<PageSize>(table_path, page_id, PageAccess::WRITE);
+    while(page){
+        for(size_t i = lower_bound(*page, record); i < page->n; ++i){
+            if(compare(record, page->key_at(i)) != 0) return false;
+            if(std::memcmp(page->record_at(i), record, record_size) == 0){
+                size_t j{ 0 };
+                page->retain([&j, i](const char*){ return j++ != i; });
+                page.mark_dirty();
+                return true;
+            }
+        }
+        if(page->next_leaf == NO_PAGE) break;
+        page = buffer_manager.table_page_at<PageSize>(table_path, page->next_leaf, PageAccess::WRITE);
+    }
+    return false;
 }
 
-// conditions aren't implemented at the moment
-void BTree::select(const std::string& table_path, BufferManager& buffer_manager, const TableSchema& table_schema, const ASTree* _select){
-    if(_select->children_size() < 3 || (_select->children_size() == 3 && _select->child_at(3)->get_type() != ASTNodeType::CONDITION)){
-        uint32_t root_id = buffer_manager.get_root_id(table_path);
-        select_no_condition(table_path, root_id, buffer_manager, table_schema, _select);
+// an index scan turns into one point lookup per primary key the index produced
+template<size_t PageSize>
+std::vector<AccessPath> BTree<PageSize>::ranges(const AccessPath& access_path) const {
+    if(access_path.method != AccessMethod::INDEX_SCAN){
+        return { access_path };
     }
+    std::vector<AccessPath> points;
+    for(size_t offset = 0; offset + key_size <= access_path.keys.size(); offset += key_size){
+        AccessPath point{};
+        point.method = AccessMethod::POINT_LOOKUP;
+        point.lower.assign(access_path.keys.begin() + offset, access_path.keys.begin() + offset + key_size);
+        point.upper = point.lower;
+        points.push_back(std::move(point));
+    }
+    return points;
 }
 
-void BTree::select_no_condition(const std::string& table_path, uint32_t page_id, BufferManager& buffer_manager, const TableSchema& table_schema, const ASTree* _select){
-    auto page = buffer_manager.table_page_at(table_path, page_id);
-    for(uint32_t i = 0; i < page->n; ++i){
-        if(!page->is_leaf){
-            select_no_condition(table_path, page->children[i], buffer_manager, table_schema, _select);
-        }
-        
-        if(page->blocks[i].is_deleted) continue;
+// the leaf and position of the first key inside the range, a full scan starts at the leftmost leaf
+template<size_t PageSize>
+typename BTree<PageSize>::Handle BTree<PageSize>::seek(const AccessPath& access_path, const std::string& table_path, BufferManager& buffer_manager, size_t& i) {
+    if(access_path.lower.empty()){
+        i = 0;
+        return first_leaf(table_path, buffer_manager);
+    }
+    Handle page = find_leaf(access_path.lower.data(), table_path, buffer_manager);
+    if(page){
+        i = access_path.lower_inclusive ? lower_bound(*page, access_path.lower.data()) : upper_bound(*page, access_path.lower.data());
+    }
+    return page;
+}
+
+template<size_t PageSize>
+bool BTree<PageSize>::past_upper(const AccessPath& access_path, const char* key) const noexcept {
+    if(access_path.upper.empty()) return false;
+    const int order{ compare(access_path.upper.data(), key) };
+    return order < 0 || (order == 0 && !access_path.upper_inclusive);
+}
 
-        std::string line;
-        auto block_data = buffer_manager.block_to_data(page->blocks[i], table_schema);
-        bool select_all = _select->child_at(0)->child_at(0)->get_token().token_type == TokenType::ASTERISK;
+template<size_t PageSize>
+BTree<PageSize>::Cursor::Cursor(BTree& btree, const std::string& table_path, BufferManager& buffer_manager, const AccessPath& access_path,
+    const LeafSpan& span) :
+    btree{ btree }, table_path{ table_path }, buffer_manager{ buffer_manager }, pending{ btree.ranges(access_path) }, span{ span }, range{ 0 }, i{ 0 } {}
 
-        if(select_all){
-            for(const auto& col : table_schema.get_columns()){
-                std::visit([&](const auto& val) {
-                    line += std::format("{}: {}|", col.name, val);
-                }, block_data[col.name]);
+// rows only live in leaves, each range seeks to its first key and walks the leaf chain until the range ends,
+// a point lookup is the same single descent search takes but keeps going over equal keys
+template<size_t PageSize>
+const char* BTree<PageSize>::Cursor::next() {
+    while(range < pending.size()){
+        if(!page){
+            if(span.first != NO_PAGE){
+                page = buffer_manager.table_page_at<PageSize>(table_path, span.first, PageAccess::READ);
+                i = 0;
+            }
+            else{
+                page = btree.seek(pending[range], table_path, buffer_manager, i);
+            }
+            if(!page){
+                ++range;
+                continue;
             }
-            std::cout << line << '\n';
         }
-        else{
-            for(const auto& col : _select->child_at(0)->get_children()){
-                std::visit([&](const auto& val) {
-                    line += std::format("{}: {}|", col->get_token().value, val);
-                }, block_data[col->get_token().value]);
+        if(i < page->n && !btree.past_upper(pending[range], page->key_at(i))){
+            return page->record_at(i++);
+        }
+        if(i < page->n || page->next_leaf == NO_PAGE || page->next_leaf == span.end){
+            page.release();
+            ++range;
+            continue;
+        }
+        page = buffer_manager.table_page_at<PageSize>(table_path, page->next_leaf, PageAccess::READ);
+        i = 0;
+        if(!page){
+            ++range;
+        }
+    }
+    return nullptr;
+}
+
+template<size_t PageSize>
+size_t BTree<PageSize>::Cursor::next_rows(const char** rows, size_t max) {
+    if(max == 0) return 0;
+    rows[0] = next();
+    if(rows[0] == nullptr) return 0;
+    size_t count{ 1 };
+    while(count < max && i < page->n && !btree.past_upper(pending[range], page->key_at(i))){
+        rows[count++] = page->record_at(i++);
+    }
+    return count;
+}
+
+// visits the rows of the access path until visit returns false
+template<size_t PageSize>
+void BTree<PageSize>::scan(const std::string& table_path, BufferManager& buffer_manager, const AccessPath& access_path,
+    const std::function<bool(const char*)>& visit){
+    Cursor cursor{ *this, table_path, buffer_manager, access_path };
+    for(const char* record = cursor.next(); record != nullptr; record = cursor.next()){
+        if(!visit(record)) return;
+    }
+}
+
+template<size_t PageSize>
+size_t BTree<PageSize>::height(const std::string& table_path, BufferManager& buffer_manager) {
+    size_t levels{ 1 };
+    Handle page = buffer_manager.root_table_page<PageSize>(table_path, PageAccess::READ);
+    while(page && page->is_leaf == 0){
+        page = buffer_manager.table_page_at<PageSize>(table_path, page->child_at(0), PageAccess::READ);
+        ++levels;
+    }
+    return levels;
+}
+
+// subtrees one level below the root, or further down until there are enough of them, each span starts at the leftmost leaf
+// of its subtree and ends where the next one starts, all leaves are at the same depth so a level is either all leaves or none
+template<size_t PageSize>
+std::vector<LeafSpan> BTree<PageSize>::partition(const std::string& table_path, BufferManager& buffer_manager, size_t count) {
+    std::vector<uint32_t> level{ buffer_manager.get_root_id(table_path) };
+    while(level.size() < count){
+        std::vector<uint32_t> children;
+        for(uint32_t page_id : level){
+            Handle page = buffer_manager.table_page_at<PageSize>(table_path, page_id, PageAccess::READ);
+            if(!page) return { LeafSpan{} };
+            if(page->is_leaf) break;
+            for(size_t j = 0; j <= page->n; ++j){
+                children.push_back(page->child_at(j));
             }
-            std::cout << line << '\n';
         }
+        if(children.empty()) break;
+        level = std::move(children);
     }
-    if(!page->is_leaf){
-        select_no_condition(table_path, page->children[page->n], buffer_manager, table_schema, _select);
+
+    std::vector<LeafSpan> spans;
+    for(uint32_t page_id : level){
+        Handle page = buffer_manager.table_page_at<PageSize>(table_path, page_id, PageAccess::READ);
+        while(page && page->is_leaf == 0){
+            page_id = page->child_at(0);
+            page = buffer_manager.table_page_at<PageSize>(table_path, page_id, PageAccess::READ);
+        }
+        if(!page) return { LeafSpan{} };
+        if(!spans.empty()) spans.back().end = page_id;
+        spans.push_back(LeafSpan{ page_id, NO_PAGE });
     }
-}
\ No newline at end of file
+    return spans;
+}
+
+template class BTree<4096>;
+template class BTree<8192>;
+template class BTree<16384>;
+template class BTree<65536>;
@@ -1,37 +1,114 @@
 #ifndef BTREE_HPP
-#define BTREE_HPP 
+#define BTREE_HPP
 
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include "../storage/page.hpp"
 #include "../BufferManager/BufferManager.hpp"
+#include "../KeySearch/KeySearch.hpp"
+#include "../Predicate/Predicate.hpp"
+#include "../../SchemaCatalog/RowView/RowView.hpp"
+#include "../../planner/planner.hpp"
 
+// leaves from first up to, but not including, end along the leaf chain, a span with no first leaf covers the whole access path
+// and end NO_PAGE runs to the last leaf, spans only narrow full scans
+struct LeafSpan {
+    uint32_t first{ NO_PAGE };
+    uint32_t end{ NO_PAGE };
+};
+
+// B+tree: rows live in leaves chained left to right, internal pages only hold separator keys,
+// records of one table have the same size, so a page splits once it can't take one more cell,
+// descents latch a child before they let go of its parent and leaves are walked left to right the same way,
+// so lookups, scans and inserts from several threads may share a tree, bulk loads and deletes of all rows may not
+template<size_t PageSize>
 class BTree {
 private:
-    void split(TablePage*, int, TablePage*, const std::string&, BufferManager&);
+    using Page = TablePage<PageSize>;
+    using Handle = PageHandle<PageSize>;
 
-    void insert_nonfull(std::unique_ptr<TablePage>&&, Block&, const std::string&, BufferManager&);
+    using KeyCompare = int (*)(const char*, const char*) noexcept;
 
-    std::unique_ptr<Block> search(std::unique_ptr<TablePage>, char*, const std::string&, BufferManager&);
+    size_t key_size;
+    size_t record_size;
+    KeyCompare key_compare;
 
-    void traverse(const std::string&, uint32_t, BufferManager&, const TableSchema&, int);
+    int compare(const char*, const char*) const noexcept;
+    bool is_full(const Page&) const noexcept;
+    size_t bound(const Page&, const char*, size_t, size_t, bool) const noexcept;
+    size_t upper_bound(const Page&, const char*) const noexcept;
+    size_t lower_bound(const Page&, const char*) const noexcept;
+
+    void split(Handle&, size_t, Handle&, size_t, const std::string&, BufferManager&);
+    size_t split_point(const Page&, const char*, bool) const noexcept;
+
+    Handle rightmost_leaf_for(const char*, const std::string&, BufferManager&);
+    Handle optimistic_leaf_for(const char*, const std::string&, BufferManager&, std::vector<char>&);
+    Handle leaf_for_insert(const char*, const std::string&, BufferManager&, std::vector<char>&);
 
-    void del_blocks(const std::string&, BufferManager&, const TableSchema&, const ASTree*);
+    Handle find_leaf(const char*, const std::string&, BufferManager&);
 
-    void select_no_condition(const std::string&, uint32_t, BufferManager&, const TableSchema&, const ASTree*);
+    Handle first_leaf(const std::string&, BufferManager&);
+
+    std::vector<AccessPath> ranges(const AccessPath&) const;
+    Handle seek(const AccessPath&, const std::string&, BufferManager&, size_t&);
+    bool past_upper(const AccessPath&, const char*) const noexcept;
+
+    void traverse(const std::string&, uint32_t, BufferManager&, const TableSchema&, int);
+
+    std::vector<char> del_records(const std::string&, BufferManager&, const TableSchema&, const ASTree*, const AccessPath&);
 
 public:
-    void insert(Block&, BufferManager&, const std::string&);
+    // hands out the rows of a planned access path one at a time in key order,
+    // the leaf holding the current row stays pinned and latched shared until the cursor moves past it
+    class Cursor {
+    public:
+        Cursor(BTree&, const std::string&, BufferManager&, const AccessPath&, const LeafSpan& = LeafSpan{});
+
+        // nullptr once the access path is exhausted
+        const char* next();
+        // up to the given number of rows, all from the same leaf, 0 once the access path is exhausted
+        size_t next_rows(const char**, size_t);
 
-    std::unique_ptr<Block> search(char*, const std::string&, BufferManager&);
+    private:
+        BTree& btree;
+        std::string table_path;
+        BufferManager& buffer_manager;
+        std::vector<AccessPath> pending;
+        LeafSpan span;
+        size_t range;
+        Handle page;
+        size_t i;
+
+    };
+
+    explicit BTree(const TableSchema&);
+
+    void insert(const std::vector<char>&, BufferManager&, const std::string&);
+
+    void insert_batch(const std::vector<std::vector<char>>&, BufferManager&, const std::string&);
+
+    void bulk_load(const std::vector<char>&, BufferManager&, const std::string&, size_t);
+
+    std::optional<std::vector<char>> search(const char*, const std::string&, BufferManager&);
 
     void traverse(const std::string&, BufferManager&, const TableSchema&);
 
-    void del(const std::string&, BufferManager&, const TableSchema&, const ASTree*);
+    std::vector<char> del(const std::string&, BufferManager&, const TableSchema&, const ASTree*, const AccessPath&);
+
+    bool erase(const char*, const std::string&, BufferManager&);
+
+    void scan(const std::string&, BufferManager&, const AccessPath&, const std::function<bool(const char*)>&);
+
+    size_t height(const std::string&, BufferManager&);
 
-    void select(const std::string&, BufferManager&, const TableSchema&, const ASTree*);
+    // consecutive spans covering every leaf, at least the given number of them unless the tree has fewer subtrees
+    std::vector<LeafSpan> partition(const std::string&, BufferManager&, size_t);
 
 };
 
@@ -1,6 +1,9 @@
 #include "BufferManager.hpp"
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <format>
@@ -9,18 +12,269 @@
 #include <iosfwd>
 #include <iostream>
 #include <filesystem>
+#include <mutex>
+#include <shared_mutex>
 #include <stdexcept>
 #include <unordered_map>
-#include <variant>
 #include <vector>
 
 #ifdef _WIN32
     #include <winsock2.h>
+    #include <fcntl.h>
+    #include <io.h>
 #else
     #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
 #endif
 
-bool BufferManager::load_schema(const std::string& path, SchemaCatalog& schema_catalog) const {
+namespace {
+
+uint64_t page_offset(uint32_t page_id, size_t page_size) {
+    return sizeof(TableHeader) + static_cast<uint64_t>(page_id) * page_size;
+}
+
+// positional I/O, the file offset of a shared descriptor is never relied upon
+bool read_at(int fd, void* buffer, size_t size, uint64_t offset) {
+    char* dst = static_cast<char*>(buffer);
+    while(size > 0){
+#ifdef _WIN32
+        if(_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0) return false;
+        int n = _read(fd, dst, static_cast<unsigned>(size));
+#else
+        ssize_t n = pread(fd, dst, size, static_cast<off_t>(offset));
+#endif
+        if(n <= 0) return false;
+        dst += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool write_at(int fd, const void* buffer, size_t size, uint64_t offset) {
+    const char* src = static_cast<const char*>(buffer);
+    while(size > 0){
+#ifdef _WIN32
+        if(_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0) return false;
+        int n = _write(fd, src, static_cast<unsigned>(size));
+#else
+        ssize_t n = pwrite(fd, src, size, static_cast<off_t>(offset));
+#endif
+        if(n <= 0) return false;
+        src += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+// row and page layout of table format version 0, only read when converting old tables
+#pragma pack(push, 1)
+struct LegacyBlock {
+    uint8_t key_type;
+    uint8_t is_deleted;
+    char key[MAX_KEY_SIZE];
+    char value[MAX_RECORD_SIZE - MAX_KEY_SIZE - sizeof(uint8_t) * 2];
+};
+
+template<size_t PageSize>
+struct LegacyTablePage {
+    static constexpr size_t ORDER = (PageSize - sizeof(uint8_t) * 2 - sizeof(uint32_t) + sizeof(LegacyBlock)) / (2 * (sizeof(LegacyBlock) + sizeof(uint32_t)));
+
+    uint8_t n;
+    uint8_t is_leaf;
+    LegacyBlock blocks[2 * ORDER - 1];
+    uint32_t children[2 * ORDER];
+    uint32_t page_id;
+    char alignment[PageSize - sizeof(blocks) - sizeof(children) - sizeof(uint8_t) * 2 - sizeof(uint32_t)];
+};
+#pragma pack(pop)
+
+// legacy blocks prefix every non-key value with its type, values that don't match the schema are dropped
+std::vector<char> legacy_record(const LegacyBlock& block, const TableSchema& table_schema) {
+    std::vector<char> record(table_schema.get_record_size());
+    size_t offset{ table_schema.get_key_size() };
+    size_t value_offset{ 0 };
+    for(const auto& column : table_schema.get_columns()){
+        const size_t size{ column_size(column.type, column.is_key) };
+        if(column.is_key){
+            std::memcpy(record.data(), block.key, size - (column.type == DataType::VARCHAR));
+            continue;
+        }
+        if(value_offset + sizeof(DataType) + MAX_STRING_LEN > sizeof(block.value)) break;
+
+        DataType type;
+        std::memcpy(&type, block.value + value_offset, sizeof(DataType));
+        const char* value = block.value + value_offset + sizeof(DataType);
+        if(type == DataType::NUMBER && column.type == DataType::NUMBER){
+            uint32_t val{};
+            std::memcpy(&val, value, sizeof(val));
+            val = ntohl(val);
+            std::memcpy(record.data() + offset, &val, sizeof(val));
+        }
+        else if(type == DataType::VARCHAR && column.type == DataType::VARCHAR){
+            std::memcpy(record.data() + offset, value, size - 1);
+        }
+        value_offset += sizeof(DataType) + (type == DataType::VARCHAR ? MAX_STRING_LEN : sizeof(uint32_t));
+        offset += size;
+    }
+    return record;
+}
+
+// writes records sorted by key as a B+tree whose pages are filled to fill_factor percent, level by level
+// from the leaves up, the first key of every page but the leftmost one becomes a separator on the level above
+template<size_t PageSize>
+uint32_t write_tree(std::ofstream& os, const std::vector<const char*>& records, size_t record_size, size_t key_size, size_t fill_factor) {
+    using Page = TablePage<PageSize>;
+    auto page = std::make_unique<Page>();
+    uint32_t next_id{ 0 };
+
+    std::vector<const char*> separators;
+    std::vector<uint32_t> children;
+    const size_t leaf_capacity{ std::max<size_t>(1, Page::DATA_SIZE / (record_size + sizeof(Slot)) * fill_factor / MAX_FILL_FACTOR) };
+    const size_t leaves{ std::max<size_t>(1, (records.size() + leaf_capacity - 1) / leaf_capacity) };
+    size_t item{ 0 };
+    for(size_t leaf = 0; leaf < leaves; ++leaf){
+        const size_t count{ records.size() / leaves + (leaf < records.size() % leaves) };
+        *page = Page{ 1, static_cast<uint8_t>(key_size) };
+        page->page_id = next_id++;
+        page->next_leaf = leaf + 1 < leaves ? next_id : NO_PAGE;
+        for(size_t k = 0; k < count; ++k){
+            std::memcpy(page->insert_cell(k, record_size), records[item++], record_size);
+        }
+        os.write(reinterpret_cast<const char*>(page.get()), sizeof(Page));
+        if(leaf > 0){
+            separators.push_back(records[item - count]);
+        }
+        children.push_back(page->page_id);
+    }
+
+    // every internal page takes count keys and count + 1 children, one key between two pages moves up
+    const size_t capacity{ std::max<size_t>(1, Page::capacity(key_size) * fill_factor / MAX_FILL_FACTOR) };
+    while(children.size() > 1){
+        const size_t nodes{ (separators.size() + capacity + 1) / (capacity + 1) };
+        const size_t in_nodes{ separators.size() - (nodes - 1) };
+
+        std::vector<const char*> upper_separators;
+        std::vector<uint32_t> upper_children;
+        size_t key{ 0 };
+        size_t child{ 0 };
+        for(size_t node = 0; node < nodes; ++node){
+            const size_t count{ in_nodes / nodes + (node < in_nodes % nodes) };
+            *page = Page{ 0, static_cast<uint8_t>(key_size) };
+            page->page_id = next_id++;
+            for(size_t k = 0; k < count; ++k){
+                page->insert_entry(k, children[child++], separators[key++]);
+            }
+            page->right_child = children[child++];
+            os.write(reinterpret_cast<const char*>(page.get()), sizeof(Page));
+            upper_children.push_back(page->page_id);
+            if(node + 1 < nodes){
+                upper_separators.push_back(separators[key++]);
+            }
+        }
+        separators = std::move(upper_separators);
+        children = std::move(upper_children);
+    }
+    return children.front();
+}
+
+// makes a written file, or the names in a directory, durable, directories cannot be synced on Windows
+void sync_path(const std::string& path, bool directory) {
+#ifdef _WIN32
+    if(directory) return;
+    int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+    int synced = fd < 0 ? -1 : _commit(fd);
+    if(fd >= 0) _close(fd);
+#else
+    int fd = open(path.c_str(), directory ? O_RDONLY | O_DIRECTORY : O_RDWR);
+    int synced = fd < 0 ? -1 : fsync(fd);
+    if(fd >= 0) close(fd);
+#endif
+    if(synced != 0){
+        throw std::runtime_error(std::format("Unable to sync '{}'\n", path));
+    }
+}
+
+void sync_directory_of(const std::string& path) {
+    const std::filesystem::path parent{ std::filesystem::path{ path }.parent_path() };
+    sync_path(parent.empty() ? "." : parent.string(), true);
+}
+
+// a complete table file holding records, which are sorted by key, it is durable before it may replace a table
+void write_table_file(const std::string& path, size_t page_size, const std::vector<const char*>& records, size_t record_size, size_t key_size, size_t fill_factor) {
+    std::ofstream os{ path, std::ios::binary | std::ios::trunc };
+    if(!os.is_open()){
+        throw std::runtime_error(std::format("Unable to open '{}'\n", path));
+    }
+    TableHeader header;
+    header.page_size = static_cast<uint32_t>(page_size);
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    header.root_id = with_page_size(page_size, [&](auto size){
+        return write_tree<decltype(size)::value>(os, records, record_size, key_size, fill_factor);
+    });
+    os.seekp(static_cast<std::streampos>(offsetof(TableHeader, root_id)));
+    os.write(reinterpret_cast<const char*>(&header.root_id), sizeof(header.root_id));
+    os.close();
+    if(!os){
+        throw std::runtime_error(std::format("Unable to write '{}'\n", path));
+    }
+    sync_path(path, false);
+    sync_directory_of(path);
+}
+
+void write_field(char* field, const Column& column, size_t size, std::string_view value) {
+    if(column.type == DataType::NUMBER){
+        // keys stay big-endian so that byte-wise comparison keeps numeric order
+        uint32_t val = static_cast<uint32_t>(std::stoul(std::string{ value }));
+        if(column.is_key){
+            val = htonl(val);
+        }
+        std::memcpy(field, &val, sizeof(val));
+    }
+    else{
+        std::memcpy(field, value.data(), std::min(value.length(), size - 1));
+    }
+}
+
+// name, columns, page size, then the table's indexes
+SchemaPage to_schema_page(const TableSchema& table_schema) {
+    SchemaPage schema_page;
+    schema_page.table_name_len = htonl(static_cast<uint32_t>(table_schema.get_table_name().size()));
+    schema_page.column_number = htonl(static_cast<uint32_t>(table_schema.columns_size()));
+    
+    size_t offset = 0;
+    
+    std::memcpy(&schema_page.data[offset], &table_schema.get_table_name()[0], table_schema.get_table_name().size());
+    offset += table_schema.get_table_name().size();
+    
+    for(const auto& col : table_schema.get_columns()) {
+        std::memcpy(&schema_page.data[offset], &col.type, sizeof(uint8_t));
+        uint8_t is_key = static_cast<uint8_t>(col.is_key);
+        std::memcpy(&schema_page.data[offset + sizeof(uint8_t)], &is_key, sizeof(uint8_t));
+        std::memcpy(&schema_page.data[offset + sizeof(col.type) + sizeof(is_key)], col.name.data(), col.name.size());
+        offset += MAX_COLUMN_LEN + sizeof(col.type) + sizeof(is_key);
+    }
+    uint32_t page_size = htonl(static_cast<uint32_t>(table_schema.get_page_size()));
+    std::memcpy(&schema_page.data[offset], &page_size, sizeof(page_size));
+    offset += sizeof(page_size);
+
+    uint32_t index_count = htonl(static_cast<uint32_t>(table_schema.get_indexes().size()));
+    std::memcpy(&schema_page.data[offset], &index_count, sizeof(index_count));
+    offset += sizeof(index_count);
+    for(const auto& index : table_schema.get_indexes()){
+        std::memcpy(&schema_page.data[offset], index.name.data(), index.name.size());
+        std::memcpy(&schema_page.data[offset + MAX_COLUMN_LEN], index.column.data(), index.column.size());
+        offset += 2 * MAX_COLUMN_LEN;
+    }
+    return schema_page;
+}
+
+}
+
+bool BufferManager::load_schema(const std::string& path, const std::string& table_path, SchemaCatalog& schema_catalog) const {
     std::ifstream file{ path, std::ios::binary };
     if(!file.is_open()){
         std::cerr << std::format("Unable to open '{}'", path);
@@ -53,32 +307,38 @@ bool BufferManager::load_schema(const std::string& path, SchemaCatalog& schema_c
             columns.push_back(Column{ column_name, type, static_cast<bool>(is_key) });
             offset += MAX_COLUMN_LEN + sizeof(DataType) + sizeof(uint8_t);
         }
+        // tables created before page sizes were configurable leave this field zeroed
+        uint32_t page_size;
+        std::memcpy(&page_size, buffer.data() + offset, sizeof(uint32_t));
+        page_size = ntohl(page_size);
+
+        offset += sizeof(uint32_t);
+
         TableSchema table_schema{table_name};
         for(const auto& col : columns){
             table_schema.add_column(col);
         }
+        if(page_size != 0){
+            table_schema.set_page_size(page_size);
+        }
+        // zero in schemas written before tables had secondary indexes
+        uint32_t index_count;
+        std::memcpy(&index_count, buffer.data() + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        for(uint32_t i = 0; i < ntohl(index_count); ++i){
+            const char* index = buffer.data() + offset;
+            table_schema.add_index(Index{ std::string{ index, strnlen(index, MAX_COLUMN_LEN) },
+                std::string{ index + MAX_COLUMN_LEN, strnlen(index + MAX_COLUMN_LEN, MAX_COLUMN_LEN) } });
+            offset += 2 * MAX_COLUMN_LEN;
+        }
+        convert_legacy_table(std::format("{}{}.db", table_path, table_name), table_schema);
         schema_catalog.add_table(table_schema);
     }
     return true;
 }
 
-void BufferManager::save_schema(const std::string& schema_path, const std::string& table_path, const TableSchema& table_schema) const {
-    SchemaPage schema_page;
-    schema_page.table_name_len = htonl(static_cast<uint32_t>(table_schema.get_table_name().size()));
-    schema_page.column_number = htonl(static_cast<uint32_t>(table_schema.columns_size()));
-    
-    size_t offset = 0;
-    
-    std::memcpy(&schema_page.data[offset], &table_schema.get_table_name()[0], table_schema.get_table_name().size());
-    offset += table_schema.get_table_name().size();
-    
-    for(const auto& col : table_schema.get_columns()) {
-        std::memcpy(&schema_page.data[offset], &col.type, sizeof(uint8_t));
-        uint8_t is_key = static_cast<uint8_t>(col.is_key);
-        std::memcpy(&schema_page.data[offset + sizeof(uint8_t)], &is_key, sizeof(uint8_t));
-        std::memcpy(&schema_page.data[offset + sizeof(col.type) + sizeof(is_key)], col.name.data(), col.name.size());
-        offset += MAX_COLUMN_LEN + sizeof(col.type) + sizeof(is_key);
-    }
+void BufferManager::save_schema(const std::string& schema_path, const std::string& table_path, const TableSchema& table_schema) {
+    const SchemaPage schema_page{ to_schema_page(table_schema) };
     {
         std::ofstream os{schema_path, std::ios::binary | std::ios::app };
         if(!os.is_open()){
@@ -87,11 +347,31 @@ void BufferManager::save_schema(const std::string& schema_path, const std::strin
         }
         os.write(reinterpret_cast<const char*>(&schema_page), sizeof(schema_page));
     }
-    init_table(std::format("{}{}{}", table_path, table_schema.get_table_name(), ".db"));
+    init_table(std::format("{}{}{}", table_path, table_schema.get_table_name(), ".db"), table_schema.get_page_size());
+}
+
+// rewrites the schema page of a table that already exists in place
+void BufferManager::update_schema(const std::string& schema_path, const TableSchema& table_schema) {
+    std::fstream file{ schema_path, std::ios::in | std::ios::out | std::ios::binary};
+    if(!file.is_open()){
+        throw std::runtime_error(std::format("Unable to open '{}'\n", schema_path));
+    }
+    std::array<char, PAGE_SIZE_> buffer;
+    for(size_t current_page = 0; file.read(buffer.data(), PAGE_SIZE_); ++current_page){
+        uint32_t table_name_len;
+        std::memcpy(&table_name_len, buffer.data(), sizeof(uint32_t));
+        if(std::string_view{ buffer.data() + 2 * sizeof(uint32_t), ntohl(table_name_len) } == table_schema.get_table_name()){
+            const SchemaPage schema_page{ to_schema_page(table_schema) };
+            file.seekp(static_cast<std::streamoff>(current_page * PAGE_SIZE_));
+            file.write(reinterpret_cast<const char*>(&schema_page), sizeof(schema_page));
+            return;
+        }
+    }
+    throw std::runtime_error(std::format("Table '{}' has no schema page\n", table_schema.get_table_name()));
 }
 
 // should optimize, instead of shifting, just swap with the last one
-void BufferManager::delete_schema(const std::string& schema_path, const std::string& table_path, const std::string& table_name, SchemaCatalog& schema_catalog) const {
+void BufferManager::delete_schema(const std::string& schema_path, const std::string& table_path, const std::string& table_name, SchemaCatalog& schema_catalog) {
     std::fstream file{ schema_path, std::ios::in | std::ios::out | std::ios::binary};
     if(!file.is_open()){
         std::cerr << std::format("Unable to open '{}'\n", schema_path);
@@ -130,195 +410,714 @@ void BufferManager::delete_schema(const std::string& schema_path, const std::str
         dst_offset += PAGE_SIZE_;
     }
     std::filesystem::resize_file(schema_path, dst_offset);
+    if(auto table_schema = schema_catalog.get_table(table_name)){
+        for(const auto& index : table_schema->get().get_indexes()){
+            remove_table(std::format("{}{}.db", table_path, table_schema->get().index_schema(index).get_table_name()));
+        }
+    }
     schema_catalog.drop_table(table_name);
-    std::filesystem::remove(table_path + table_name + ".db");
+    remove_table(table_path + table_name + ".db");
 }
 
-std::unique_ptr<TablePage> BufferManager::table_page_at(const std::string& table_path, uint32_t page_id) const {
-    std::ifstream file{ table_path, std::ios::binary };
-    if(!file.is_open()) {
-        return nullptr;
+void BufferManager::remove_table(const std::string& table_path) {
+    discard_table(table_path);
+    std::filesystem::remove(table_path);
+}
+
+// frame_count is a budget in default-sized pages, pools of larger pages get proportionally fewer frames
+BufferManager::BufferManager(size_t frame_count, StorageMode storage_mode) : 
+    pool_budget{ frame_count * PAGE_SIZE_ }, storage_mode{ storage_mode } {
+    
+    if(frame_count == 0){
+        throw std::invalid_argument("Buffer pool requires at least one frame\n");
+    }
+#ifdef _WIN32
+    if(storage_mode == StorageMode::MMAP){
+        throw std::invalid_argument("Memory-mapped storage is not supported on this platform\n");
+    }
+#endif
+    page_table.reserve(frame_count);
+}
+
+BufferManager::~BufferManager() {
+    try{
+        if(wal != nullptr){
+            checkpoint();
+        }
+        else{
+            flush_all();
+        }
+    }
+    catch(const std::exception& ex){
+        std::cerr << std::format("Failed to flush buffer pool: {}\n", ex.what());
+    }
+    while(!table_files.empty()){
+        close_table(table_files.begin()->first);
     }
+}
 
-    file.seekg(static_cast<std::streampos>(sizeof(uint32_t) + page_id * PAGE_SIZE_));
-    if(!file || file.eof()) return nullptr;
+size_t BufferManager::PageKeyHash::operator()(const PageKey& key) const noexcept {
+    return std::hash<std::string>{}(key.table_path) ^ (std::hash<uint32_t>{}(key.page_id) << 1);
+}
 
-    std::array<char, PAGE_SIZE_> buffer;
-    file.read(buffer.data(), PAGE_SIZE_);
-    
-    if(file.gcount() != PAGE_SIZE_) return nullptr;
+BufferManager::FrameRef BufferManager::fetch_page(const std::string& table_path, uint32_t page_id, PageAccess access, size_t page_size) {
+    std::lock_guard guard{ latch };
+    auto it = page_table.find(PageKey{ table_path, page_id });
+    if(it != page_table.end()){
+        FrameInfo& info = frame_info[it->second];
+        ++info.pin_count;
+        info.referenced = true;
+        return FrameRef{ it->second, frames[it->second].data, page_id, frames[it->second].latch };
+    }
 
-    std::unique_ptr<TablePage> table_page = std::make_unique<TablePage>();
-    std::memcpy(table_page.get(), buffer.data(), PAGE_SIZE_);
-    
-    for(uint8_t i = 0; i < table_page->n + 1; ++i){
-        table_page->children[i] = ntohl(table_page->children[i]);
+    const TableFile& table_file = open_table(table_path);
+    if(table_file.page_size != page_size){
+        throw std::runtime_error(std::format("Table '{}' uses {} byte pages, not {}\n", table_path, table_file.page_size, page_size));
+    }
+    // pages are only written back while the pool latch is held and nobody views the table, so this cannot fail
+    if(access == PageAccess::READ && table_file.mapping != nullptr){
+        if(page_id >= table_file.page_count) return FrameRef{ NO_FRAME, nullptr, page_id, nullptr };
+        if(!table_file.view_latch->try_lock_shared()){
+            throw std::runtime_error(std::format("Table '{}' is being written back\n", table_path));
+        }
+        return FrameRef{ NO_FRAME, table_file.mapping + page_offset(page_id, page_size), page_id, table_file.view_latch.get() };
     }
-    table_page->page_id = ntohl(table_page->page_id);
 
-    return table_page;
+    size_t frame_id = acquire_frame(page_size);
+    if(!read_page(table_file, page_id, frames[frame_id].data)){
+        return FrameRef{ NO_FRAME, nullptr, page_id, nullptr };
+    }
+    frame_info[frame_id] = FrameInfo{ PageKey{ table_path, page_id }, 1, false, true, true, true };
+    page_table.emplace(frame_info[frame_id].key, frame_id);
+    return FrameRef{ frame_id, frames[frame_id].data, page_id, frames[frame_id].latch };
 }
 
-std::unique_ptr<TablePage> BufferManager::root_table_page(const std::string& table_path) const {
-    std::ifstream file{ table_path, std::ios::binary };
-    if(!file.is_open()) {
-        return nullptr;
+BufferManager::FrameRef BufferManager::allocate_page(const std::string& table_path, size_t page_size) {
+    std::lock_guard guard{ latch };
+    if(open_table(table_path).page_size != page_size){
+        throw std::runtime_error(std::format("Table '{}' does not use {} byte pages\n", table_path, page_size));
     }
-    std::array<char, PAGE_SIZE_> buffer;
-    file.read(buffer.data(), sizeof(uint32_t));
-    if(file.gcount() != sizeof(uint32_t)) return nullptr;
+    uint32_t page_id = new_page_id(table_path);
+    size_t frame_id = acquire_frame(page_size);
 
-    uint32_t root_id{};
-    std::memcpy(&root_id, buffer.data(), sizeof(uint32_t));
-    root_id = ntohl(root_id);
+    // the frame is dirty already, a commit must not log it before it is built, nobody holds
+    // a free frame's latch, so trying it cannot fail and never waits while the pool latch is held
+    if(!frames[frame_id].latch->try_lock()){
+        throw std::runtime_error(std::format("Free frame {} is latched\n", frame_id));
+    }
+    frame_info[frame_id] = FrameInfo{ PageKey{ table_path, page_id }, 1, true, true, true, false };
+    page_table.emplace(frame_info[frame_id].key, frame_id);
+    return FrameRef{ frame_id, frames[frame_id].data, page_id, frames[frame_id].latch };
+}
 
-    file.seekg(static_cast<std::streampos>(PAGE_SIZE_ * root_id + sizeof(uint32_t)));
-    file.read(buffer.data(), PAGE_SIZE_);
-    if(file.gcount() != PAGE_SIZE_) return nullptr;
+void BufferManager::flush_all() {
+    std::lock_guard guard{ latch };
+    write_back();
+}
 
-    TablePage table_page;
-    std::memcpy(&table_page, buffer.data(), PAGE_SIZE_);
+// a page someone holds for writing may be half changed and a viewed table must not change under its readers,
+// such pages are left dirty for a later flush, true once no dirty page is left
+bool BufferManager::write_back() {
+    bool clean{ true };
+    for(size_t i = 0; i < frames.size(); ++i){
+        if(!frame_info[i].in_use || !frame_info[i].dirty) continue;
 
-    for(uint8_t i = 0; i < table_page.n + 1; ++i){
-        table_page.children[i] = ntohl(table_page.children[i]);
+        std::shared_lock frame_guard{ *frames[i].latch, std::try_to_lock };
+        if(!frame_guard.owns_lock() || viewed(frame_info[i].key.table_path)){
+            clean = false;
+            continue;
+        }
+        flush_frame(i);
     }
-    table_page.page_id = ntohl(table_page.page_id);
+    for(auto& [table_path, table_file] : table_files){
+        if(!table_file.dirty) continue;
 
-    return std::make_unique<TablePage>(table_page);
+        if(!write_table(table_file, &table_file.root_id, sizeof(table_file.root_id), offsetof(TableHeader, root_id))){
+            throw std::runtime_error(std::format("Unable to write '{}'\n", table_path));
+        }
+        table_file.dirty = false;
+    }
+    return clean;
 }
 
-void BufferManager::write_page(const std::string& table_path, const TablePage* table_page) const {
-    std::fstream file{ table_path, std::ios::binary | std::ios::in | std::ios::out};
-    if(!file.is_open()){
-        std::cerr << std::format("Unable to open '{}'\n", table_path);
+// replays committed log groups into the table files and starts logging every change made afterwards
+void BufferManager::open_wal(const std::string& wal_path) {
+    wal = std::make_unique<WriteAheadLog>(wal_path);
+    if(wal->size() == 0) return;
+
+    wal->replay([this](const WalRecord& record){ apply_log_record(record); });
+    flush_all();
+    sync_tables();
+    wal->truncate();
+}
+
+// group commit: every change since the previous commit reaches the log with a single fsync,
+// pages themselves are written back lazily on eviction or at the next checkpoint
+void BufferManager::commit() {
+    std::lock_guard guard{ latch };
+    if(wal == nullptr){
+        write_back();
         return;
     }
-    TablePage page{ *table_page };
-    for(uint8_t i = 0; i < page.n + 1; ++i){
-        page.children[i] = htonl(page.children[i]);
+    log_changes();
+    release_overflow();
+    if(wal->size() > WAL_CHECKPOINT_SIZE){
+        write_checkpoint();
     }
-    page.page_id = htonl(page.page_id);
-    
-    file.seekp(static_cast<std::streampos>(table_page->page_id * PAGE_SIZE_ + sizeof(uint32_t)));
-    file.write(reinterpret_cast<const char*>(&page), PAGE_SIZE_);    
 }
 
-uint32_t BufferManager::new_page_id(const std::string& table_path) const {
-    std::ifstream file{ table_path, std::ios::binary | std::ios::ate };
-    if(!file.is_open()){
-        throw std::runtime_error(std::format("Unable to open '{}'\n", table_path));
+void BufferManager::checkpoint() {
+    std::lock_guard guard{ latch };
+    if(wal == nullptr){
+        write_back();
+        return;
     }
-    
-    std::streampos file_size = file.tellg();
-    if(file_size <= static_cast<std::streampos>(sizeof(uint32_t))){
-        throw std::runtime_error(std::format("Corrupted table '{}'\n", table_path));
+    write_checkpoint();
+}
+
+// the log stays the only good copy of a page that could not be written back, so it is kept until a later checkpoint,
+// true once the log is truncated
+bool BufferManager::write_checkpoint() {
+    log_changes();
+    release_overflow();
+    if(!write_back()) return false;
+    sync_tables();
+    wal->truncate();
+    return true;
+}
+
+// a page latch is never waited for here, a page someone holds for writing goes into a later group
+void BufferManager::log_changes() {
+    for(size_t i = 0; i < frames.size(); ++i){
+        FrameInfo& info = frame_info[i];
+        if(!info.in_use || !info.dirty || info.logged) continue;
+
+        std::shared_lock frame_guard{ *frames[i].latch, std::try_to_lock };
+        if(frame_guard.owns_lock()){
+            wal->append_page(info.key.table_path, info.key.page_id, frames[i].data, static_cast<uint32_t>(frames[i].page_size));
+            info.logged = true;
+        }
+    }
+    for(auto& [table_path, table_file] : table_files){
+        if(table_file.dirty && !table_file.logged){
+            wal->append_root(table_path, table_file.root_id);
+            table_file.logged = true;
+        }
+    }
+    if(wal->has_pending()){
+        wal->commit();
     }
-    return (static_cast<uint32_t>(file_size) - sizeof(uint32_t)) / PAGE_SIZE_;
 }
 
-void BufferManager::update_root_id(const std::string& table_path, uint32_t root_id) const {
-    std::fstream file{ table_path, std::ios::binary | std::ios::in | std::ios::out };
-    file.seekp(std::ios::beg);
+BufferManager::FramePool& BufferManager::get_pool(size_t page_size) {
+    for(auto& pool : pools){
+        if(pool.page_size == page_size && !pool.overflow) return pool;
+    }
+    return add_pool(page_size, std::max(MIN_POOL_FRAMES, pool_budget / page_size), false);
+}
 
-    root_id = htonl(root_id);
-    file.write(reinterpret_cast<const char*>(&root_id), sizeof(root_id));
+BufferManager::FramePool& BufferManager::add_pool(size_t page_size, size_t frame_count, bool overflow) {
+    for(auto& pool : pools){
+        if(overflow && pool.retired && pool.frame_count >= frame_count){
+            fill_pool(pool, page_size);
+            return pool;
+        }
+    }
+    FramePool pool{ page_size, frames.size(), frame_count, 0, nullptr, nullptr, overflow, false };
+    frames.resize(frames.size() + frame_count);
+    frame_info.resize(frames.size());
+    page_table.reserve(frames.size());
+    fill_pool(pool, page_size);
+    pools.push_back(std::move(pool));
+    return pools.back();
 }
 
-uint32_t BufferManager::get_root_id(const std::string& table_path) const {
-    std::ifstream file{ table_path, std::ios::binary };
-    if(!file.is_open()){
-        throw std::runtime_error(std::format("Unable to open '{}'", table_path));
+void BufferManager::fill_pool(FramePool& pool, size_t page_size) {
+    pool.page_size = page_size;
+    pool.clock_hand = 0;
+    pool.retired = false;
+    pool.memory = std::make_unique<char[]>(pool.frame_count * page_size + CACHE_LINE_SIZE);
+    pool.latches = std::make_unique<std::shared_mutex[]>(pool.frame_count);
+    const uintptr_t address{ reinterpret_cast<uintptr_t>(pool.memory.get()) };
+    char* first = pool.memory.get() + (CACHE_LINE_SIZE - address % CACHE_LINE_SIZE) % CACHE_LINE_SIZE;
+    for(size_t i = 0; i < pool.frame_count; ++i){
+        frames[pool.first_frame + i] = Frame{ first + i * page_size, page_size, &pool.latches[i] };
     }
-    uint32_t root_id{};
-    file.read(reinterpret_cast<char*>(&root_id), sizeof(root_id));
-    return ntohl(root_id);
 }
 
-Block BufferManager::data_to_block(const ASTree* columns, const ASTree* values, const TableSchema& table_schema) const {
-    std::unordered_map<std::string, std::string> col_map;
-    Block block;
+// CLOCK: a frame survives one sweep after being referenced, pinned frames are never evicted,
+// with a log a script's changes may fill every frame before it commits, then the pool grows by an overflow
+// pool as large as all frames of that size so far, committing early would log half a statement
+size_t BufferManager::acquire_frame(size_t page_size) {
+    get_pool(page_size);
+    size_t frame_count{ 0 };
+    for(FramePool& pool : pools){
+        if(pool.page_size != page_size || pool.retired) continue;
+        const size_t frame_id = find_victim(pool);
+        if(frame_id != frames.size()) return frame_id;
+        frame_count += pool.frame_count;
+    }
+    if(wal == nullptr){
+        throw std::runtime_error(std::format("Buffer pool exhausted, all {} frames of {} bytes are pinned\n", frame_count, page_size));
+    }
+    return add_pool(page_size, frame_count, true).first_frame;
+}
 
-    size_t offset{ 0 };
-    for(size_t i = 0; i < columns->children_size(); ++i){
-        col_map[columns->child_at(i)->get_token().value] = values->child_at(i)->get_token().value;
-    }
-    const size_t columns_size{ table_schema.columns_size() };
-    for(size_t i = 0; i < columns_size; ++i){
-        const Column& column{ table_schema.get_column_at(i) };
-        auto col_it = col_map.find(column.name);
-        if(col_it != col_map.end()){
-            if(column.is_key){
-                block.key_type = static_cast<uint8_t>(column.type);
-                if(column.type == DataType::NUMBER){
-                    uint32_t val = htonl(std::stoul(col_it->second));
-                    std::memcpy(block.key, &val, sizeof(val));
-                }
-                else{
-                    std::memcpy(block.key, col_it->second.c_str(), col_it->second.length());
-                }
-            }
-            else{
-                uint8_t type = static_cast<uint8_t>(column.type);
-                std::memcpy(block.value + offset, &type, sizeof(type));
-                if(column.type == DataType::NUMBER){
-                    uint32_t val = htonl(std::stoul(col_it->second));
-                    std::memcpy(block.value + offset + sizeof(type), &val, sizeof(val));
-                }
-                else{
-                    std::memcpy(block.value + offset + sizeof(type), col_it->second.c_str(), col_it->second.length());
+// frees every overflow pool nothing pins once its changes are in the log, so they may be written back,
+// retired pools at the end of the frame table are dropped, the others keep their range for reuse
+void BufferManager::release_overflow() {
+    for(FramePool& pool : pools){
+        if(!pool.overflow || pool.retired) continue;
+
+        const size_t end{ pool.first_frame + pool.frame_count };
+        bool busy{ false };
+        for(size_t i = pool.first_frame; i < end && !busy; ++i){
+            const FrameInfo& info = frame_info[i];
+            busy = info.in_use && (info.pin_count > 0 || (info.dirty && (!info.logged || viewed(info.key.table_path))));
+        }
+        if(busy) continue;
+
+        for(size_t i = pool.first_frame; i < end; ++i){
+            FrameInfo& info = frame_info[i];
+            if(info.in_use){
+                if(info.dirty){
+                    flush_frame(i);
                 }
+                page_table.erase(info.key);
             }
-            offset += (column.is_key ?  0 : (sizeof(DataType) + (column.type == DataType::VARCHAR ? MAX_STRING_LEN : sizeof(uint32_t))));
-        }   
+            info = FrameInfo{};
+            frames[i] = Frame{ nullptr, pool.page_size, nullptr };
+        }
+        pool.memory.reset();
+        pool.latches.reset();
+        pool.retired = true;
+    }
+    while(!pools.empty() && pools.back().retired){
+        frames.resize(pools.back().first_frame);
+        frame_info.resize(frames.size());
+        pools.pop_back();
     }
-    return block;
 }
 
-std::unordered_map<std::string, std::variant<std::string, uint32_t>> BufferManager::block_to_data(const Block& block, const TableSchema& table_schema) const {
-    std::unordered_map<std::string, std::variant<std::string, uint32_t>> data;
-    const size_t columns_size{ table_schema.columns_size() };
-    size_t offset{ 0 };
-    for(size_t i = 0; i < columns_size; ++i){
-        const Column& column{ table_schema.get_column_at(i) };
-        if(column.is_key){
-            if(static_cast<DataType>(block.key_type) == DataType::VARCHAR){
-                data[column.name] = std::string{ block.key, MAX_COLUMN_LEN }.c_str();
-            }
-            else{
-                uint32_t val{};
-                std::memcpy(&val, block.key, sizeof(val));
-                data[column.name] = ntohl(val);
-            }
+// changes that are not in the log yet are never written to the table file
+size_t BufferManager::find_victim(FramePool& pool) {
+    for(size_t scanned = 0; scanned < 2 * pool.frame_count; ++scanned){
+        size_t frame_id = pool.first_frame + pool.clock_hand;
+        pool.clock_hand = (pool.clock_hand + 1) % pool.frame_count;
+
+        FrameInfo& info = frame_info[frame_id];
+        if(!info.in_use){
+            return frame_id;
         }
-        else{
-            DataType type;
-            std::memcpy(&type, block.value + offset, sizeof(DataType));
-            if(type == DataType::VARCHAR){
-                data[column.name] = std::string { block.value + offset + sizeof(DataType), MAX_COLUMN_LEN }.c_str();
-            }
-            else{
-                uint32_t val{};
-                std::memcpy(&val, block.value + offset + sizeof(DataType), sizeof(val));
-                data[column.name] = ntohl(val);
-            }
-            offset += sizeof(DataType) + (type == DataType::VARCHAR ? MAX_STRING_LEN : sizeof(uint32_t));
+        if(info.pin_count > 0){
+            continue;
+        }
+        if(info.referenced){
+            info.referenced = false;
+            continue;
+        }
+        if(info.dirty && ((!info.logged && wal != nullptr) || viewed(info.key.table_path))){
+            continue;
+        }
+        if(info.dirty){
+            flush_frame(frame_id);
+        }
+        page_table.erase(info.key);
+        info.in_use = false;
+        return frame_id;
+    }
+    return frames.size();
+}
+
+// new views need the pool latch, so a table nobody views now stays unviewed while the caller holds it
+bool BufferManager::viewed(const std::string& table_path) {
+    if(storage_mode != StorageMode::MMAP) return false;
+    auto it = table_files.find(table_path);
+    if(it == table_files.end()) return false;
+    std::unique_lock view_guard{ *it->second.view_latch, std::try_to_lock };
+    return !view_guard.owns_lock();
+}
+
+void BufferManager::flush_frame(size_t frame_id) {
+    write_page(frame_info[frame_id].key.table_path, frame_info[frame_id].key.page_id, frames[frame_id].data);
+    frame_info[frame_id].dirty = false;
+}
+
+// a table about to be truncated or removed must not be in use, its pages reach the file first, the log is then
+// truncated or, when a page someone holds for writing keeps it, told never to replay the table's earlier records
+void BufferManager::discard_table(const std::string& table_path) {
+    std::lock_guard guard{ latch };
+    for(size_t i = 0; i < frames.size(); ++i){
+        const FrameInfo& info = frame_info[i];
+        if(info.in_use && info.key.table_path == table_path && info.pin_count > 0){
+            throw std::runtime_error(std::format("Table '{}' is in use\n", table_path));
+        }
+    }
+    if(viewed(table_path)){
+        throw std::runtime_error(std::format("Table '{}' is in use\n", table_path));
+    }
+    if(wal != nullptr && !write_checkpoint()){
+        sync_tables();
+        wal->append_discard(table_path);
+        wal->commit();
+    }
+    for(size_t i = 0; i < frames.size(); ++i){
+        FrameInfo& info = frame_info[i];
+        if(info.in_use && info.key.table_path == table_path){
+            page_table.erase(info.key);
+            info = FrameInfo{};
+        }
+    }
+    close_table(table_path);
+}
+
+void BufferManager::sync_tables() {
+    for(auto& [table_path, table_file] : table_files){
+#ifdef _WIN32
+        int synced = _commit(table_file.fd);
+#else
+        if(table_file.mapping != nullptr){
+            msync(table_file.mapping, table_file.mapped_size, MS_SYNC);
+        }
+        int synced = fsync(table_file.fd);
+#endif
+        if(synced != 0){
+            throw std::runtime_error(std::format("Unable to sync '{}'\n", table_path));
+        }
+    }
+}
+
+// page images are idempotent, replaying a group that already reached the table file is harmless
+void BufferManager::apply_log_record(const WalRecord& record) {
+    if(!std::filesystem::exists(record.table_path)) return;
+
+    TableFile& table_file = open_table(record.table_path);
+    if(record.type == WalRecordType::ROOT){
+        table_file.root_id = record.page_id;
+        table_file.dirty = true;
+        table_file.logged = true;
+        return;
+    }
+    if(record.payload.size() != table_file.page_size) return;
+
+    if(record.page_id >= table_file.page_count){
+        if(table_file.mapping != nullptr){
+            extend_table(record.table_path, table_file, page_offset(record.page_id + 1, table_file.page_size));
+        }
+        table_file.page_count = record.page_id + 1;
+    }
+    if(!write_table(table_file, record.payload.data(), table_file.page_size, page_offset(record.page_id, table_file.page_size))){
+        throw std::runtime_error(std::format("Unable to write '{}'\n", record.table_path));
+    }
+}
+
+void BufferManager::mark_dirty(size_t frame_id) noexcept {
+    std::lock_guard guard{ latch };
+    frame_info[frame_id].dirty = true;
+    frame_info[frame_id].logged = false;
+}
+
+void BufferManager::unpin(size_t frame_id) noexcept {
+    std::lock_guard guard{ latch };
+    if(frame_info[frame_id].pin_count > 0){
+        --frame_info[frame_id].pin_count;
+    }
+}
+
+// a frame's latch lives as long as its pool, so a handle reaches it without the pool latch
+void BufferManager::lock_frame(std::shared_mutex& frame_latch, PageAccess access) noexcept {
+    if(access == PageAccess::WRITE){
+        frame_latch.lock();
+    }
+    else{
+        frame_latch.lock_shared();
+    }
+}
+
+void BufferManager::unlock_frame(std::shared_mutex& frame_latch, PageAccess access) noexcept {
+    if(access == PageAccess::WRITE){
+        frame_latch.unlock();
+    }
+    else{
+        frame_latch.unlock_shared();
+    }
+}
+
+BufferManager::TableFile& BufferManager::open_table(const std::string& table_path) {
+    auto it = table_files.find(table_path);
+    if(it != table_files.end()){
+        return it->second;
+    }
+
+#ifdef _WIN32
+    int fd = _open(table_path.c_str(), _O_RDWR | _O_BINARY);
+    int64_t file_size = fd < 0 ? -1 : _lseeki64(fd, 0, SEEK_END);
+#else
+    int fd = open(table_path.c_str(), O_RDWR);
+    int64_t file_size = fd < 0 ? -1 : lseek(fd, 0, SEEK_END);
+#endif
+    if(fd < 0){
+        throw std::runtime_error(std::format("Unable to open '{}'\n", table_path));
+    }
+    TableHeader header;
+    bool valid{ file_size >= static_cast<int64_t>(sizeof(TableHeader)) && read_at(fd, &header, sizeof(header), 0) && 
+        std::memcmp(header.magic, TABLE_MAGIC, sizeof(TABLE_MAGIC)) == 0 && header.version == TABLE_FORMAT_VERSION && 
+        header.little_endian == (std::endian::native == std::endian::little) };
+    if(valid && header.page_size == 0){
+        header.page_size = PAGE_SIZE_;
+    }
+    if(!valid || !is_supported_page_size(header.page_size)){
+#ifdef _WIN32
+        _close(fd);
+#else
+        close(fd);
+#endif
+        throw std::runtime_error(std::format("Corrupted or unsupported table '{}'\n", table_path));
+    }
+
+    TableFile table_file{ fd, header.root_id, static_cast<uint32_t>((static_cast<size_t>(file_size) - sizeof(TableHeader)) / header.page_size), 
+        header.page_size, false, true, static_cast<uint64_t>(file_size), nullptr, 0, NO_PAGE, std::make_shared<std::shared_mutex>(),
+        std::make_shared<std::shared_mutex>() };
+    TableFile& opened = table_files.emplace(table_path, table_file).first->second;
+    if(storage_mode == StorageMode::MMAP){
+        try{
+            map_table(table_path, opened);
+        }
+        catch(...){
+            close_table(table_path);
+            throw;
         }
     }
-    return data;
+    return opened;
+}
+
+void BufferManager::close_table(const std::string& table_path) {
+    auto it = table_files.find(table_path);
+    if(it == table_files.end()) return;
+#ifdef _WIN32
+    _close(it->second.fd);
+#else
+    if(it->second.mapping != nullptr){
+        munmap(it->second.mapping, MMAP_RESERVE_SIZE);
+    }
+    close(it->second.fd);
+#endif
+    table_files.erase(it);
+}
+
+// the whole reservation is claimed up front so the mapping never moves while pages are pinned
+void BufferManager::map_table(const std::string& table_path, TableFile& table_file) {
+#ifndef _WIN32
+    void* reserved = mmap(nullptr, MMAP_RESERVE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(reserved == MAP_FAILED){
+        throw std::runtime_error(std::format("Unable to reserve address space for '{}'\n", table_path));
+    }
+    table_file.mapping = static_cast<char*>(reserved);
+
+    const size_t os_page{ static_cast<size_t>(sysconf(_SC_PAGESIZE)) };
+    const size_t mapped_size{ (table_file.file_size + os_page - 1) / os_page * os_page };
+    if(mmap(table_file.mapping, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, table_file.fd, 0) == MAP_FAILED){
+        throw std::runtime_error(std::format("Unable to map '{}'\n", table_path));
+    }
+    table_file.mapped_size = mapped_size;
+#else
+    (void)table_path;
+    (void)table_file;
+#endif
+}
+
+// grows the file and, when needed, maps the next part of the reservation in place
+void BufferManager::extend_table(const std::string& table_path, TableFile& table_file, uint64_t file_size) {
+#ifndef _WIN32
+    if(ftruncate(table_file.fd, static_cast<off_t>(file_size)) != 0){
+        throw std::runtime_error(std::format("Unable to extend '{}'\n", table_path));
+    }
+    table_file.file_size = file_size;
+    if(file_size <= table_file.mapped_size) return;
+
+    const size_t os_page{ static_cast<size_t>(sysconf(_SC_PAGESIZE)) };
+    size_t mapped_size{ std::max<size_t>(table_file.mapped_size * 2, (file_size + os_page - 1) / os_page * os_page) };
+    if(mapped_size > MMAP_RESERVE_SIZE){
+        throw std::runtime_error(std::format("Table '{}' exceeds the mapping reservation\n", table_path));
+    }
+    void* extended = mmap(table_file.mapping + table_file.mapped_size, mapped_size - table_file.mapped_size, 
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, table_file.fd, static_cast<off_t>(table_file.mapped_size));
+    if(extended == MAP_FAILED){
+        throw std::runtime_error(std::format("Unable to map '{}'\n", table_path));
+    }
+    table_file.mapped_size = mapped_size;
+#else
+    (void)table_path;
+    (void)table_file;
+    (void)file_size;
+#endif
+}
+
+bool BufferManager::read_table(const TableFile& table_file, void* buffer, size_t size, uint64_t offset) const {
+    if(table_file.mapping == nullptr){
+        return read_at(table_file.fd, buffer, size, offset);
+    }
+    if(offset + size > table_file.file_size) return false;
+    std::memcpy(buffer, table_file.mapping + offset, size);
+    return true;
+}
+
+bool BufferManager::write_table(const TableFile& table_file, const void* buffer, size_t size, uint64_t offset) const {
+    if(table_file.mapping == nullptr){
+        return write_at(table_file.fd, buffer, size, offset);
+    }
+    if(offset + size > table_file.file_size) return false;
+    std::memcpy(table_file.mapping + offset, buffer, size);
+    return true;
+}
+
+bool BufferManager::read_page(const TableFile& table_file, uint32_t page_id, char* data) const {
+    if(page_id >= table_file.page_count) return false;
+    return read_table(table_file, data, table_file.page_size, page_offset(page_id, table_file.page_size));
+}
+
+void BufferManager::write_page(const std::string& table_path, uint32_t page_id, const char* data) {
+    const TableFile& table_file = open_table(table_path);
+    if(!write_table(table_file, data, table_file.page_size, page_offset(page_id, table_file.page_size))){
+        throw std::runtime_error(std::format("Unable to write '{}'\n", table_path));
+    }
+}
+
+uint32_t BufferManager::new_page_id(const std::string& table_path) {
+    TableFile& table_file = open_table(table_path);
+    if(table_file.mapping != nullptr){
+        extend_table(table_path, table_file, page_offset(table_file.page_count + 1, table_file.page_size));
+    }
+    return table_file.page_count++;
+}
+
+void BufferManager::update_root_id(const std::string& table_path, uint32_t root_id) {
+    std::lock_guard guard{ latch };
+    TableFile& table_file = open_table(table_path);
+    table_file.root_id = root_id;
+    table_file.dirty = true;
+    table_file.logged = false;
+}
+
+uint32_t BufferManager::get_root_id(const std::string& table_path) {
+    std::lock_guard guard{ latch };
+    return open_table(table_path).root_id;
+}
+
+// only a hint, callers check that the page is still the last leaf before using it
+uint32_t BufferManager::get_rightmost_leaf(const std::string& table_path) {
+    std::lock_guard guard{ latch };
+    return open_table(table_path).rightmost_leaf;
 }
 
-void BufferManager::delete_all_data(const std::string& table_path) const {
+void BufferManager::set_rightmost_leaf(const std::string& table_path, uint32_t page_id) {
+    std::lock_guard guard{ latch };
+    open_table(table_path).rightmost_leaf = page_id;
+}
+
+size_t BufferManager::get_page_size(const std::string& table_path) {
+    std::lock_guard guard{ latch };
+    return open_table(table_path).page_size;
+}
+
+// the latch lives as long as the table stays open, tables are only closed while nobody uses them
+std::shared_mutex& BufferManager::root_latch(const std::string& table_path) {
+    std::lock_guard guard{ latch };
+    return *open_table(table_path).root_latch;
+}
+
+// frames the pool of that page size holds, the most pages of that size that can be pinned at once
+size_t BufferManager::frame_count(size_t page_size) {
+    std::lock_guard guard{ latch };
+    return get_pool(page_size).frame_count;
+}
+
+// columns left out of the INSERT stay zeroed
+std::vector<char> BufferManager::data_to_record(const ASTree* columns, const ASTree* values, const TableSchema& table_schema) const {
+    std::vector<char> record(table_schema.get_record_size());
+    for(size_t i = 0; i < columns->children_size(); ++i){
+        const size_t index{ table_schema.get_column_index(columns->child_at(i)->get_token().value) };
+        const ColumnLayout& layout{ table_schema.get_layout()[index] };
+        write_field(record.data() + layout.offset, table_schema.get_column_at(index), layout.width, values->child_at(i)->get_token().value);
+    }
+    return record;
+}
+
+// values are given for every column in declaration order, record has room for get_record_size() bytes
+void BufferManager::row_to_record(const std::vector<std::string_view>& values, const TableSchema& table_schema, char* record) const {
+    std::memset(record, 0, table_schema.get_record_size());
+    for(size_t i = 0; i < values.size(); ++i){
+        const ColumnLayout& layout{ table_schema.get_layout()[i] };
+        write_field(record + layout.offset, table_schema.get_column_at(i), layout.width, values[i]);
+    }
+}
+
+void BufferManager::delete_all_data(const std::string& table_path) {
+    const size_t page_size{ get_page_size(table_path) };
+    discard_table(table_path);
     std::filesystem::resize_file(table_path, 0);
-    init_table(table_path);
+    init_table(table_path, page_size);
 }
 
-void BufferManager::init_table(const std::string& table_path) const {
+void BufferManager::init_table(const std::string& table_path, size_t page_size) {
+    discard_table(table_path);
     std::ofstream os{ table_path, std::ios::binary };
     if(!os.is_open()){
         throw std::runtime_error(std::format("Unable to open '{}'\n", table_path));
     }
-    TablePage table_page;
-    uint32_t initial_root_id = 0;
-    os.write(reinterpret_cast<const char*>(&initial_root_id), sizeof(initial_root_id)); //offset of a root on first 4 bytes
-    os.write(reinterpret_cast<const char*>(&table_page), sizeof(table_page));
-}
\ No newline at end of file
+    TableHeader header;
+    header.page_size = static_cast<uint32_t>(page_size);
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    with_page_size(page_size, [&os](auto size){
+        auto table_page = std::make_unique<TablePage<decltype(size)::value>>();
+        os.write(reinterpret_cast<const char*>(table_page.get()), sizeof(*table_page));
+    });
+}
+
+// version 0 tables start with a big-endian root id instead of a header and store NUMBER values in network
+// byte order, they are rebuilt once as a B+tree of slotted pages
+void BufferManager::convert_legacy_table(const std::string& table_path, const TableSchema& table_schema) const {
+    std::ifstream file{ table_path, std::ios::binary };
+    if(!file.is_open()) return;
+
+    char magic[sizeof(TABLE_MAGIC)];
+    if(!file.read(magic, sizeof(magic)) || std::memcmp(magic, TABLE_MAGIC, sizeof(TABLE_MAGIC)) == 0){
+        return;
+    }
+
+    std::vector<std::vector<char>> records;
+    const size_t record_size{ table_schema.get_record_size() };
+    auto page = std::make_unique<LegacyTablePage<PAGE_SIZE_>>();
+    file.seekg(static_cast<std::streampos>(sizeof(uint32_t)));
+    while(file.read(reinterpret_cast<char*>(page.get()), sizeof(*page))){
+        for(uint8_t i = 0; i < page->n; ++i){
+            if(page->blocks[i].is_deleted) continue;
+            records.push_back(legacy_record(page->blocks[i], table_schema));
+        }
+    }
+    const size_t key_size{ table_schema.get_key_size() };
+    std::stable_sort(records.begin(), records.end(), [key_size](const auto& a, const auto& b){
+        return std::memcmp(a.data(), b.data(), key_size) < 0;
+    });
+
+    std::vector<const char*> sorted(records.size());
+    std::transform(records.begin(), records.end(), sorted.begin(), [](const auto& record){ return record.data(); });
+
+    const std::string converted_path{ table_path + ".tmp" };
+    write_table_file(converted_path, PAGE_SIZE_, sorted, record_size, key_size, MAX_FILL_FACTOR);
+    file.close();
+    std::filesystem::rename(converted_path, table_path);
+    sync_directory_of(table_path);
+}
+
+// the old file stays complete until the rebuilt one replaces it, so the log is checkpointed first
+void BufferManager::rebuild_table(const std::string& table_path, const std::vector<const char*>& records, size_t record_size, size_t key_size, size_t fill_factor) {
+    const size_t page_size{ get_page_size(table_path) };
+    checkpoint();
+
+    const std::string rebuilt_path{ table_path + ".tmp" };
+    write_table_file(rebuilt_path, page_size, records, record_size, key_size, fill_factor);
+    discard_table(table_path);
+    std::filesystem::rename(rebuilt_path, table_path);
+    sync_directory_of(table_path);
+}
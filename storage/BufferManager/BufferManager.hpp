@@ -1,33 +1,334 @@
 #ifndef BUFFER_MANAGER_HPP
 #define BUFFER_MANAGER_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <new>
 #include <memory>
-#include <variant>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include "../../SchemaCatalog/SchemaCatalog/SchemaCatalog.hpp"
 #include "../storage/page.hpp"
+#include "../WriteAheadLog/WriteAheadLog.hpp"
 #include "../../ASTree/ASTree.hpp"
 
+constexpr size_t DEFAULT_FRAME_COUNT = 256;
+constexpr size_t MMAP_RESERVE_SIZE = size_t{ 1 } << 32; // address space reserved per mapped table
+
+// BUFFERED reads pages with pread, MMAP serves them from a shared mapping of the table file,
+// a view into the mapping holds the table's view latch, pages of a viewed table are not written back,
+// so a view never sees a page half written, a pooled copy is served instead once a page is in the pool
+enum class StorageMode { BUFFERED, MMAP };
+
+// READ pages may be views into a mapped table, WRITE pages always live in a pool frame,
+// a pooled page is latched shared for READ and exclusively for WRITE for as long as its handle lives,
+// a view does not latch its page, a scan through views may miss rows a concurrent split moves
+enum class PageAccess { READ, WRITE };
+
+class BufferManager;
+
+// pins and latches a frame of the buffer pool for as long as it lives, or views a page of a mapped table
+template<size_t PageSize>
+class PageHandle {
+public:
+    using Page = TablePage<PageSize>;
+
+    PageHandle() noexcept;
+    PageHandle(BufferManager*, size_t, Page*, std::shared_mutex*, PageAccess) noexcept;
+    PageHandle(PageHandle&&) noexcept;
+    PageHandle& operator=(PageHandle&&) noexcept;
+    PageHandle(const PageHandle&) = delete;
+    PageHandle& operator=(const PageHandle&) = delete;
+    ~PageHandle();
+
+    Page* get() const noexcept;
+    Page* operator->() const noexcept;
+    Page& operator*() const noexcept;
+    explicit operator bool() const noexcept;
+
+    void mark_dirty() const noexcept;
+    void release() noexcept;
+
+private:
+    BufferManager* buffer_manager;
+    size_t frame_id;
+    Page* page;
+    std::shared_mutex* frame_latch;
+    PageAccess access;
+
+};
+
 class BufferManager {
 public:
-    bool load_schema(const std::string&, SchemaCatalog&) const;
-    void save_schema(const std::string&, const std::string&, const TableSchema&) const;
-    void delete_schema(const std::string&, const std::string&, const std::string&, SchemaCatalog&) const;
+    explicit BufferManager(size_t frame_count = DEFAULT_FRAME_COUNT, StorageMode storage_mode = StorageMode::BUFFERED);
+    ~BufferManager();
+    BufferManager(const BufferManager&) = delete;
+    BufferManager& operator=(const BufferManager&) = delete;
+
+    bool load_schema(const std::string&, const std::string&, SchemaCatalog&) const;
+    void save_schema(const std::string&, const std::string&, const TableSchema&);
+    void update_schema(const std::string&, const TableSchema&);
+    void delete_schema(const std::string&, const std::string&, const std::string&, SchemaCatalog&);
+
+    template<size_t PageSize>
+    PageHandle<PageSize> table_page_at(const std::string&, uint32_t, PageAccess);
+    // the root latch is held until the root page is latched, so a root split can't slip in between
+    template<size_t PageSize>
+    PageHandle<PageSize> root_table_page(const std::string&, PageAccess);
+    // held exclusively by a writer that may split the root, shared by everyone else reaching the root page
+    std::shared_mutex& root_latch(const std::string&);
+    template<size_t PageSize>
+    PageHandle<PageSize> new_page(const std::string&, uint8_t, size_t);
+    void flush_all();
+
+    void open_wal(const std::string&);
+    void commit();
+    void checkpoint();
+
+    uint32_t new_page_id(const std::string&);
+    void update_root_id(const std::string&, uint32_t);
+    uint32_t get_root_id(const std::string&);
+    uint32_t get_rightmost_leaf(const std::string&);
+    void set_rightmost_leaf(const std::string&, uint32_t);
+    size_t get_page_size(const std::string&);
+    size_t frame_count(size_t);
+
+    std::vector<char> data_to_record(const ASTree*, const ASTree*, const TableSchema&) const;
+    void row_to_record(const std::vector<std::string_view>&, const TableSchema&, char*) const;
+    void delete_all_data(const std::string& table_path);
+
+    void init_table(const std::string& table_path, size_t page_size);
+    void remove_table(const std::string&);
+    void convert_legacy_table(const std::string&, const TableSchema&) const;
+    void rebuild_table(const std::string&, const std::vector<const char*>&, size_t, size_t, size_t);
+
+private:
+    template<size_t> friend class PageHandle;
+
+    static constexpr size_t NO_FRAME = SIZE_MAX;
+    static constexpr size_t MIN_POOL_FRAMES = 16;
+
+    // frame_id is NO_FRAME and latch the table's view latch, taken shared already, for views into a mapped table
+    struct FrameRef {
+        size_t frame_id;
+        char* data;
+        uint32_t page_id;
+        std::shared_mutex* latch;
+    };
 
-    std::unique_ptr<TablePage> table_page_at(const std::string&, uint32_t) const;
-    std::unique_ptr<TablePage> root_table_page(const std::string&) const;
-    void write_page(const std::string&, const TablePage*) const;
+    struct PageKey {
+        std::string table_path;
+        uint32_t page_id;
 
-    uint32_t new_page_id(const std::string&) const;
-    void update_root_id(const std::string&, uint32_t) const;
-    uint32_t get_root_id(const std::string&) const;
+        bool operator==(const PageKey&) const noexcept = default;
+    };
 
-    Block data_to_block(const ASTree*, const ASTree*, const TableSchema&) const;
-    std::unordered_map<std::string, std::variant<std::string, uint32_t>> block_to_data(const Block&, const TableSchema&) const;
-    void delete_all_data(const std::string& table_path) const;
+    struct PageKeyHash {
+        size_t operator()(const PageKey&) const noexcept;
+    };
 
-    void init_table(const std::string& table_path) const;
+    struct Frame {
+        char* data;
+        size_t page_size;
+        std::shared_mutex* latch;
+    };
+
+    // frames of one page size, a pool is created when the first table using that size is touched,
+    // its frames start on a cache line, their latches stay put when later pools are added,
+    // overflow pools only hold changes a script has not committed yet and go away once it has,
+    // a retired pool keeps its frame range for the next overflow pool so later frame ids never move
+    struct FramePool {
+        size_t page_size;
+        size_t first_frame;
+        size_t frame_count;
+        size_t clock_hand;
+        std::unique_ptr<char[]> memory;
+        std::unique_ptr<std::shared_mutex[]> latches;
+        bool overflow;
+        bool retired;
+    };
+
+    struct FrameInfo {
+        PageKey key;
+        uint32_t pin_count;
+        bool dirty;
+        bool referenced;
+        bool in_use;
+        bool logged;
+    };
+
+    // opened once and kept until the table is dropped or the manager is destroyed
+    struct TableFile {
+        int fd;
+        uint32_t root_id;
+        uint32_t page_count;
+        uint32_t page_size;
+        bool dirty;
+        bool logged;
+        uint64_t file_size;
+        char* mapping;
+        size_t mapped_size;
+        uint32_t rightmost_leaf; // NO_PAGE until an insert finds it
+        std::shared_ptr<std::shared_mutex> root_latch;
+        std::shared_ptr<std::shared_mutex> view_latch; // held shared by every view into the mapping
+    };
+
+    std::vector<Frame> frames;
+    std::vector<FrameInfo> frame_info;
+    std::vector<FramePool> pools;
+    std::unordered_map<PageKey, size_t, PageKeyHash> page_table;
+    std::unordered_map<std::string, TableFile> table_files;
+    size_t pool_budget;
+    StorageMode storage_mode;
+    std::unique_ptr<WriteAheadLog> wal;
+    // guards the frame table and the open tables, never held while waiting for a page latch
+    std::mutex latch;
+
+    TableFile& open_table(const std::string&);
+    void close_table(const std::string&);
+    void map_table(const std::string&, TableFile&);
+    void extend_table(const std::string&, TableFile&, uint64_t);
+    bool read_table(const TableFile&, void*, size_t, uint64_t) const;
+    bool write_table(const TableFile&, const void*, size_t, uint64_t) const;
+    FrameRef fetch_page(const std::string&, uint32_t, PageAccess, size_t);
+    FrameRef allocate_page(const std::string&, size_t);
+    FramePool& get_pool(size_t);
+    FramePool& add_pool(size_t, size_t, bool);
+    void fill_pool(FramePool&, size_t);
+    void release_overflow();
+    size_t acquire_frame(size_t);
+    size_t find_victim(FramePool&);
+    bool viewed(const std::string&);
+    void flush_frame(size_t);
+    void discard_table(const std::string&);
+    void mark_dirty(size_t) noexcept;
+    void unpin(size_t) noexcept;
+    static void lock_frame(std::shared_mutex&, PageAccess) noexcept;
+    static void unlock_frame(std::shared_mutex&, PageAccess) noexcept;
+    bool write_back();
+    bool write_checkpoint();
+    void log_changes();
+    void sync_tables();
+    void apply_log_record(const WalRecord&);
+
+    bool read_page(const TableFile&, uint32_t, char*) const;
+    void write_page(const std::string&, uint32_t, const char*);
 
 };
 
+template<size_t PageSize>
+PageHandle<PageSize>::PageHandle() noexcept : buffer_manager{ nullptr }, frame_id{ 0 }, page{ nullptr }, frame_latch{ nullptr }, access{ PageAccess::READ } {}
+
+template<size_t PageSize>
+PageHandle<PageSize>::PageHandle(BufferManager* buffer_manager, size_t frame_id, Page* page, std::shared_mutex* frame_latch, PageAccess access) noexcept : 
+    buffer_manager{ buffer_manager }, frame_id{ frame_id }, page{ page }, frame_latch{ frame_latch }, access{ access } {}
+
+template<size_t PageSize>
+PageHandle<PageSize>::PageHandle(PageHandle&& other) noexcept : buffer_manager{ other.buffer_manager }, frame_id{ other.frame_id }, page{ other.page },
+    frame_latch{ other.frame_latch }, access{ other.access } {
+    other.buffer_manager = nullptr;
+    other.page = nullptr;
+    other.frame_latch = nullptr;
+}
+
+template<size_t PageSize>
+PageHandle<PageSize>& PageHandle<PageSize>::operator=(PageHandle&& other) noexcept {
+    if(this != &other){
+        release();
+        buffer_manager = other.buffer_manager;
+        frame_id = other.frame_id;
+        page = other.page;
+        frame_latch = other.frame_latch;
+        access = other.access;
+        other.buffer_manager = nullptr;
+        other.page = nullptr;
+        other.frame_latch = nullptr;
+    }
+    return *this;
+}
+
+template<size_t PageSize>
+PageHandle<PageSize>::~PageHandle() {
+    release();
+}
+
+template<size_t PageSize>
+TablePage<PageSize>* PageHandle<PageSize>::get() const noexcept {
+    return page;
+}
+
+template<size_t PageSize>
+TablePage<PageSize>* PageHandle<PageSize>::operator->() const noexcept {
+    return page;
+}
+
+template<size_t PageSize>
+TablePage<PageSize>& PageHandle<PageSize>::operator*() const noexcept {
+    return *page;
+}
+
+template<size_t PageSize>
+PageHandle<PageSize>::operator bool() const noexcept {
+    return page != nullptr;
+}
+
+template<size_t PageSize>
+void PageHandle<PageSize>::mark_dirty() const noexcept {
+    if(buffer_manager != nullptr){
+        buffer_manager->mark_dirty(frame_id);
+    }
+}
+
+template<size_t PageSize>
+void PageHandle<PageSize>::release() noexcept {
+    if(frame_latch != nullptr){
+        BufferManager::unlock_frame(*frame_latch, access);
+        frame_latch = nullptr;
+    }
+    if(buffer_manager != nullptr){
+        buffer_manager->unpin(frame_id);
+        buffer_manager = nullptr;
+    }
+    page = nullptr;
+}
+
+template<size_t PageSize>
+PageHandle<PageSize> BufferManager::table_page_at(const std::string& table_path, uint32_t page_id, PageAccess access) {
+    FrameRef frame = fetch_page(table_path, page_id, access, PageSize);
+    if(frame.data == nullptr){
+        return PageHandle<PageSize>{};
+    }
+    if(frame.frame_id == NO_FRAME){
+        return PageHandle<PageSize>{ nullptr, frame.frame_id, reinterpret_cast<TablePage<PageSize>*>(frame.data), frame.latch, access };
+    }
+    // the pin keeps the frame from being reused while this waits for the latch
+    lock_frame(*frame.latch, access);
+    return PageHandle<PageSize>{ this, frame.frame_id, reinterpret_cast<TablePage<PageSize>*>(frame.data), frame.latch, access };
+}
+
+template<size_t PageSize>
+PageHandle<PageSize> BufferManager::root_table_page(const std::string& table_path, PageAccess access) {
+    std::shared_mutex& root{ root_latch(table_path) };
+    if(access == PageAccess::WRITE){
+        std::lock_guard guard{ root };
+        return table_page_at<PageSize>(table_path, get_root_id(table_path), access);
+    }
+    std::shared_lock guard{ root };
+    return table_page_at<PageSize>(table_path, get_root_id(table_path), access);
+}
+
+template<size_t PageSize>
+PageHandle<PageSize> BufferManager::new_page(const std::string& table_path, uint8_t is_leaf, size_t key_size) {
+    // comes back latched for writing
+    FrameRef frame = allocate_page(table_path, PageSize);
+    TablePage<PageSize>* page = new (frame.data) TablePage<PageSize>{ is_leaf, static_cast<uint8_t>(key_size) };
+    page->page_id = frame.page_id;
+    return PageHandle<PageSize>{ this, frame.frame_id, page, frame.latch, PageAccess::WRITE };
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "KeySearch.hpp"
+
+#include <bit>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define KEY_SEARCH_X86 1
+    #include <immintrin.h>
+#else
+    #define KEY_SEARCH_X86 0
+#endif
+
+namespace {
+
+// the vector searches scan at most this many keys, larger ranges are halved first
+constexpr size_t SIMD_WINDOW = 64;
+
+size_t count_less_scalar(const int32_t* keys, size_t n, int32_t probe) noexcept {
+    size_t i = 0;
+    while(i < n && keys[i] < probe) {
+        ++i;
+    }
+    return i;
+}
+
+size_t count_less_binary(const int32_t* keys, size_t n, int32_t probe) noexcept {
+    size_t low{ 0 }, high{ n };
+    while(low < high) {
+        const size_t mid{ low + (high - low) / 2 };
+        if(keys[mid] < probe) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// keys before low are less than probe and keys from high on aren't, once at most SIMD_WINDOW keys are left between them
+void narrow(const int32_t* keys, size_t& low, size_t& high, int32_t probe) noexcept {
+    while(high - low > SIMD_WINDOW) {
+        const size_t mid{ low + (high - low) / 2 };
+        if(keys[mid] < probe) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+}
+
+#if KEY_SEARCH_X86
+// keys are sorted, so the scan stops at the first vector that isn't entirely below the probe
+__attribute__((target("sse2")))
+size_t count_less_sse2(const int32_t* keys, size_t n, int32_t probe) noexcept {
+    size_t low{ 0 }, high{ n };
+    narrow(keys, low, high, probe);
+    const __m128i probes = _mm_set1_epi32(probe);
+    size_t i = low;
+    for(; i + 4 <= high; i += 4) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(probes, block))));
+        if(mask != 0xF) return i + static_cast<size_t>(std::popcount(mask));
+    }
+    while(i < high && keys[i] < probe) {
+        ++i;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t count_less_avx2(const int32_t* keys, size_t n, int32_t probe) noexcept {
+    size_t low{ 0 }, high{ n };
+    narrow(keys, low, high, probe);
+    const __m256i probes = _mm256_set1_epi32(probe);
+    size_t i = low;
+    for(; i + 8 <= high; i += 8) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(probes, block))));
+        if(mask != 0xFF) return i + static_cast<size_t>(std::popcount(mask));
+    }
+    while(i < high && keys[i] < probe) {
+        ++i;
+    }
+    return i;
+}
+#endif
+
+CountLess best_count_less() noexcept {
+    for(KeySearchKind kind : { KeySearchKind::AVX2, KeySearchKind::SSE2 }) {
+        if(CountLess search = count_less_for(kind)) return search;
+    }
+    return count_less_binary;
+}
+
+}
+
+CountLess count_less_for(KeySearchKind kind) noexcept {
+    switch(kind) {
+        case KeySearchKind::SCALAR:
+            return count_less_scalar;
+        case KeySearchKind::BINARY:
+            return count_less_binary;
+#if KEY_SEARCH_X86
+        case KeySearchKind::SSE2:
+            return __builtin_cpu_supports("sse2") ? count_less_sse2 : nullptr;
+        case KeySearchKind::AVX2:
+            return __builtin_cpu_supports("avx2") ? count_less_avx2 : nullptr;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+size_t count_less(const int32_t* keys, size_t n, int32_t probe) noexcept {
+    static const CountLess search{ best_count_less() };
+    return search(keys, n, probe);
+}
@@ -0,0 +1,18 @@
+#ifndef KEY_SEARCH_HPP
+#define KEY_SEARCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// every search counts the keys of a sorted array that are less than the probe, which is the probe's lower bound
+enum class KeySearchKind { SCALAR, BINARY, SSE2, AVX2 };
+
+using CountLess = size_t (*)(const int32_t*, size_t, int32_t) noexcept;
+
+// nullptr when neither the build nor the CPU supports the kind
+CountLess count_less_for(KeySearchKind) noexcept;
+
+// fastest kind the CPU supports, picked on first use
+size_t count_less(const int32_t*, size_t, int32_t) noexcept;
+
+#endif
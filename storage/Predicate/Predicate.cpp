@@ -0,0 +1,226 @@
+#include "Predicate.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// string columns are compared over their whole padded width, keys and values have the same one
+static_assert(MAX_KEY_SIZE == MAX_STRING_LEN, "string keys and values are compared over the same width");
+
+namespace {
+
+uint8_t accepted_orders(TokenType op) {
+    switch(op){
+        case TokenType::EQUAL:
+            return 0b010;
+        case TokenType::NOT_EQUAL:
+            return 0b101;
+        case TokenType::LESS:
+            return 0b001;
+        case TokenType::LESS_EQUAL:
+            return 0b011;
+        case TokenType::GREATER:
+            return 0b100;
+        case TokenType::GREATER_EQUAL:
+            return 0b110;
+        default:
+            throw std::runtime_error(std::format("Invalid comparison operator '{}'\n", token_type_str.at(op)));
+    }
+}
+
+// a < b turns into b > a
+uint8_t mirrored(uint8_t accept) noexcept {
+    return static_cast<uint8_t>((accept & 0b010) | (accept & 0b001) << 2 | (accept & 0b100) >> 2);
+}
+
+uint32_t load_number(const char* field, bool is_key) noexcept {
+    uint32_t number;
+    std::memcpy(&number, field, sizeof(number));
+    if constexpr(std::endian::native == std::endian::little){
+        if(is_key) number = std::byteswap(number);
+    }
+    return number;
+}
+
+int order_of(uint32_t a, uint32_t b) noexcept {
+    return (a > b) - (a < b);
+}
+
+int order_of(int memcmp_result) noexcept {
+    return (memcmp_result > 0) - (memcmp_result < 0);
+}
+
+bool holds(uint8_t accept, int order) noexcept {
+    return (accept >> (order + 1)) & 1u;
+}
+
+}
+
+Predicate::Predicate(const ASTree* conditions, const TableSchema& table_schema) {
+    if(conditions != nullptr){
+        compile(conditions->child_at(0), table_schema, 0);
+    }
+}
+
+bool Predicate::empty() const noexcept {
+    return program.empty();
+}
+
+void Predicate::compile(const ASTree* condition, const TableSchema& table_schema, size_t depth) {
+    if(depth >= MAX_DEPTH){
+        throw std::runtime_error(std::format("Conditions may nest at most {} levels deep\n", MAX_DEPTH));
+    }
+    const TokenType connective{ condition->get_token().token_type };
+    if(connective == TokenType::AND || connective == TokenType::OR){
+        compile(condition->child_at(0), table_schema, depth);
+        compile(condition->child_at(1), table_schema, depth + 1);
+        program.push_back(Instruction{ connective == TokenType::AND ? Op::AND : Op::OR, 0, 0, 0, 0, 0, 0, 0 });
+        return;
+    }
+    program.push_back(compile_comparison(condition, table_schema));
+}
+
+// columns go to the left of constants, comparisons between two constants are decided here
+Predicate::Instruction Predicate::compile_comparison(const ASTree* condition, const TableSchema& table_schema) {
+    const ASTree* left = condition->child_at(0);
+    const ASTree* right = condition->child_at(1);
+    uint8_t accept{ accepted_orders(condition->get_token().token_type) };
+    if(left->get_type() != ASTNodeType::ID && right->get_type() == ASTNodeType::ID){
+        std::swap(left, right);
+        accept = mirrored(accept);
+    }
+
+    const bool number{ left->get_token().token_type == TokenType::NUMBER_LITERAL ||
+        (left->get_type() == ASTNodeType::ID && table_schema.get_column(left->get_token().value)->get().type == DataType::NUMBER) };
+    if(left->get_type() != ASTNodeType::ID){
+        const std::string& a{ left->get_token().value };
+        const std::string& b{ right->get_token().value };
+        const int order{ number ? order_of(static_cast<uint32_t>(std::stoul(a)), static_cast<uint32_t>(std::stoul(b))) : order_of(a.compare(b)) };
+        return Instruction{ Op::CONST, 0, 0, 0, 0, holds(accept, order), 0, 0 };
+    }
+
+    Instruction instruction{ Op::CONST, accept, static_cast<uint16_t>(table_schema.get_column_offset(left->get_token().value)), 0, 0, 0,
+        static_cast<uint16_t>(table_schema.get_column_index(left->get_token().value)), 0 };
+    instruction.key_side = table_schema.get_column(left->get_token().value)->get().is_key;
+    if(right->get_type() == ASTNodeType::ID){
+        instruction.op = number ? Op::NUMBER_COLUMNS : Op::STRING_COLUMNS;
+        instruction.right = static_cast<uint16_t>(table_schema.get_column_offset(right->get_token().value));
+        instruction.right_column = static_cast<uint16_t>(table_schema.get_column_index(right->get_token().value));
+        instruction.key_side |= static_cast<uint8_t>(table_schema.get_column(right->get_token().value)->get().is_key << 1);
+    }
+    else if(number){
+        instruction.op = Op::NUMBER_CONST;
+        instruction.number = static_cast<uint32_t>(std::stoul(right->get_token().value));
+    }
+    else{
+        instruction.op = Op::STRING_CONST;
+        instruction.right = static_cast<uint16_t>(strings.size());
+        std::array<char, MAX_STRING_LEN> padded{};
+        std::memcpy(padded.data(), right->get_token().value.data(), std::min(right->get_token().value.size(), padded.size() - 1));
+        strings.push_back(padded);
+    }
+    return instruction;
+}
+
+// the program is postfix, every comparison pushes one bit and AND/OR replace the top two bits by one
+bool Predicate::matches(const char* record) const noexcept {
+    uint64_t stack{ 1 };
+    for(const Instruction& instruction : program){
+        bool result{ false };
+        switch(instruction.op){
+            case Op::NUMBER_CONST:
+                result = holds(instruction.accept, order_of(load_number(record + instruction.left, instruction.key_side & 1u), instruction.number));
+                break;
+            case Op::STRING_CONST:
+                result = holds(instruction.accept, order_of(std::memcmp(record + instruction.left, strings[instruction.right].data(), MAX_STRING_LEN)));
+                break;
+            case Op::NUMBER_COLUMNS:
+                result = holds(instruction.accept, order_of(load_number(record + instruction.left, instruction.key_side & 1u),
+                    load_number(record + instruction.right, instruction.key_side & 2u)));
+                break;
+            case Op::STRING_COLUMNS:
+                result = holds(instruction.accept, order_of(std::memcmp(record + instruction.left, record + instruction.right, MAX_STRING_LEN)));
+                break;
+            case Op::CONST:
+                result = instruction.number != 0;
+                break;
+            case Op::AND:
+                result = (stack & 1u) && (stack & 2u);
+                stack >>= 2;
+                break;
+            case Op::OR:
+                result = (stack & 1u) || (stack & 2u);
+                stack >>= 2;
+                break;
+        }
+        stack = stack << 1 | result;
+    }
+    return stack & 1u;
+}
+
+// each comparison fills one byte per row of the batch in a loop over its columns, AND/OR fold the two topmost
+// result rows into one, a stack level per instruction is enough since every instruction pushes at most one
+void Predicate::filter(RowBatch& batch) {
+    if(program.empty()) return;
+    results.resize(program.size() * BATCH_SIZE);
+    const size_t n{ batch.size };
+    size_t top{ 0 };
+    for(const Instruction& instruction : program){
+        uint8_t* out{ results.data() + top * BATCH_SIZE };
+        switch(instruction.op){
+            case Op::NUMBER_CONST: {
+                const uint32_t* left{ batch.columns[instruction.left_column].numbers.data() };
+                for(size_t i = 0; i < n; ++i){
+                    out[i] = holds(instruction.accept, order_of(left[i], instruction.number));
+                }
+                break;
+            }
+            case Op::STRING_CONST: {
+                const char* left{ batch.columns[instruction.left_column].strings.data() };
+                const char* constant{ strings[instruction.right].data() };
+                for(size_t i = 0; i < n; ++i){
+                    out[i] = holds(instruction.accept, order_of(std::memcmp(left + i * MAX_STRING_LEN, constant, MAX_STRING_LEN)));
+                }
+                break;
+            }
+            case Op::NUMBER_COLUMNS: {
+                const uint32_t* left{ batch.columns[instruction.left_column].numbers.data() };
+                const uint32_t* right{ batch.columns[instruction.right_column].numbers.data() };
+                for(size_t i = 0; i < n; ++i){
+                    out[i] = holds(instruction.accept, order_of(left[i], right[i]));
+                }
+                break;
+            }
+            case Op::STRING_COLUMNS: {
+                const char* left{ batch.columns[instruction.left_column].strings.data() };
+                const char* right{ batch.columns[instruction.right_column].strings.data() };
+                for(size_t i = 0; i < n; ++i){
+                    out[i] = holds(instruction.accept, order_of(std::memcmp(left + i * MAX_STRING_LEN, right + i * MAX_STRING_LEN, MAX_STRING_LEN)));
+                }
+                break;
+            }
+            case Op::CONST:
+                std::fill(out, out + n, static_cast<uint8_t>(instruction.number != 0));
+                break;
+            case Op::AND:
+            case Op::OR: {
+                uint8_t* lhs{ out - 2 * BATCH_SIZE };
+                const uint8_t* rhs{ out - BATCH_SIZE };
+                if(instruction.op == Op::AND){
+                    for(size_t i = 0; i < n; ++i) lhs[i] &= rhs[i];
+                }
+                else{
+                    for(size_t i = 0; i < n; ++i) lhs[i] |= rhs[i];
+                }
+                top -= 2;
+                break;
+            }
+        }
+        ++top;
+    }
+    std::erase_if(batch.selection, [this](uint16_t row){ return results[row] == 0; });
+}
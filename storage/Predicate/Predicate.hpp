@@ -0,0 +1,55 @@
+#ifndef PREDICATE_HPP
+#define PREDICATE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../../ASTree/ASTree.hpp"
+#include "../../SchemaCatalog/TableSchema/TableSchema.hpp"
+#include "../storage/page.hpp"
+#include "../../executor/RowBatch/RowBatch.hpp"
+
+// a WHERE condition compiled once per query into a postfix program over record bytes,
+// comparisons read columns at fixed offsets and AND/OR combine their results on a bit stack,
+// a batch runs the same program over whole columns
+class Predicate {
+public:
+    // accepts every record
+    Predicate() = default;
+    // conditions is a CONDITIONS node, or nullptr for no condition
+    Predicate(const ASTree*, const TableSchema&);
+
+    bool matches(const char*) const noexcept;
+    // batch columns are the table's columns in declaration order
+    void filter(RowBatch&);
+    bool empty() const noexcept;
+
+private:
+    enum class Op : uint8_t { NUMBER_CONST, STRING_CONST, NUMBER_COLUMNS, STRING_COLUMNS, CONST, AND, OR };
+
+    // accept has bit 0, 1 and 2 set when the comparison holds for less, equal and greater
+    struct Instruction {
+        Op op;
+        uint8_t accept;
+        uint16_t left;     // column offset
+        uint16_t right;    // column offset, or index into strings
+        uint8_t key_side;  // bit 0 and 1 set when the left and right column are the big-endian key
+        uint32_t number;   // constant of NUMBER_CONST, result of CONST
+        uint16_t left_column;  // column index in a batch
+        uint16_t right_column;
+    };
+
+    static constexpr size_t MAX_DEPTH = 64;
+
+    std::vector<Instruction> program;
+    std::vector<std::array<char, MAX_STRING_LEN>> strings;
+    std::vector<uint8_t> results; // BATCH_SIZE bytes per stack level while a batch is filtered
+
+    void compile(const ASTree*, const TableSchema&, size_t);
+    Instruction compile_comparison(const ASTree*, const TableSchema&);
+
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "SecondaryIndex.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+template<size_t PageSize>
+SecondaryIndex<PageSize>::SecondaryIndex(const TableSchema& table_schema, const Index& index, const std::string& index_path) :
+    table_schema{ table_schema }, index_schema{ table_schema.index_schema(index) }, btree{ index_schema }, index_path{ index_path },
+    column_offset{ table_schema.get_column_offset(index.column) }, column_type{ table_schema.get_column(index.column)->get().type },
+    value_size{ index_schema.get_key_size() }, key_size{ table_schema.get_key_size() } {}
+
+// NUMBER values become big-endian like keys, so entries order by value
+template<size_t PageSize>
+std::vector<char> SecondaryIndex<PageSize>::entry(const char* record) const {
+    std::vector<char> entry(value_size + key_size);
+    std::memcpy(entry.data(), record + column_offset, value_size);
+    if(column_type == DataType::NUMBER){
+        uint32_t number;
+        std::memcpy(&number, entry.data(), sizeof(number));
+        if constexpr(std::endian::native == std::endian::little){
+            number = std::byteswap(number);
+        }
+        std::memcpy(entry.data(), &number, sizeof(number));
+    }
+    std::memcpy(entry.data() + value_size, record, key_size);
+    return entry;
+}
+
+// rewrites the index from every row of the table, bottom-up like a bulk load
+template<size_t PageSize>
+void SecondaryIndex<PageSize>::build(const std::string& table_path, BufferManager& buffer_manager) {
+    std::vector<char> entries;
+    BTree<PageSize> table{ table_schema };
+    table.scan(table_path, buffer_manager, AccessPath{}, [&](const char* record){
+        const std::vector<char> indexed{ entry(record) };
+        entries.insert(entries.end(), indexed.begin(), indexed.end());
+        return true;
+    });
+
+    const size_t entry_size{ value_size + key_size };
+    std::vector<const char*> sorted;
+    sorted.reserve(entries.size() / entry_size);
+    for(size_t offset = 0; offset < entries.size(); offset += entry_size){
+        sorted.push_back(entries.data() + offset);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [entry_size](const char* a, const char* b){ return std::memcmp(a, b, entry_size) < 0; });
+    buffer_manager.rebuild_table(index_path, sorted, entry_size, value_size, MAX_FILL_FACTOR);
+}
+
+template<size_t PageSize>
+void SecondaryIndex<PageSize>::insert(const std::vector<std::vector<char>>& records, BufferManager& buffer_manager) {
+    std::vector<std::vector<char>> entries;
+    entries.reserve(records.size());
+    for(const auto& record : records){
+        entries.push_back(entry(record.data()));
+    }
+    btree.insert_batch(entries, buffer_manager, index_path);
+}
+
+// records are the removed rows of the table, back to back
+template<size_t PageSize>
+void SecondaryIndex<PageSize>::erase(const std::vector<char>& records, BufferManager& buffer_manager) {
+    const size_t record_size{ table_schema.get_record_size() };
+    for(size_t offset = 0; offset < records.size(); offset += record_size){
+        btree.erase(entry(records.data() + offset).data(), index_path, buffer_manager);
+    }
+}
+
+template<size_t PageSize>
+void SecondaryIndex<PageSize>::clear(BufferManager& buffer_manager) {
+    buffer_manager.delete_all_data(index_path);
+}
+
+// primary keys of the entries inside the planned range, sorted and without repeats
+template<size_t PageSize>
+std::vector<char> SecondaryIndex<PageSize>::primary_keys(const AccessPath& access_path, BufferManager& buffer_manager) {
+    AccessPath range{ access_path };
+    range.method = AccessMethod::RANGE_SCAN;
+
+    std::vector<std::vector<char>> keys;
+    btree.scan(index_path, buffer_manager, range, [&](const char* indexed){
+        keys.emplace_back(indexed + value_size, indexed + value_size + key_size);
+        return true;
+    });
+    std::sort(keys.begin(), keys.end(), [](const auto& a, const auto& b){ return std::memcmp(a.data(), b.data(), a.size()) < 0; });
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<char> sorted;
+    sorted.reserve(keys.size() * key_size);
+    for(const auto& key : keys){
+        sorted.insert(sorted.end(), key.begin(), key.end());
+    }
+    return sorted;
+}
+
+template class SecondaryIndex<4096>;
+template class SecondaryIndex<8192>;
+template class SecondaryIndex<16384>;
+template class SecondaryIndex<65536>;
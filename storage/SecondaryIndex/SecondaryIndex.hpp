@@ -0,0 +1,39 @@
+#ifndef SECONDARY_INDEX_HPP
+#define SECONDARY_INDEX_HPP
+
+#include <string>
+#include <vector>
+
+#include "../BTree/BTree.hpp"
+#include "../BufferManager/BufferManager.hpp"
+#include "../../planner/planner.hpp"
+
+// (column value, primary key) entries of one index kept in a B+tree of their own and ordered by value,
+// the value is stored the way a key is and the primary key is copied the way the table stores it
+template<size_t PageSize>
+class SecondaryIndex {
+public:
+    SecondaryIndex(const TableSchema&, const Index&, const std::string&);
+
+    void build(const std::string&, BufferManager&);
+    void insert(const std::vector<std::vector<char>>&, BufferManager&);
+    void erase(const std::vector<char>&, BufferManager&);
+    void clear(BufferManager&);
+
+    std::vector<char> primary_keys(const AccessPath&, BufferManager&);
+
+private:
+    TableSchema table_schema;
+    TableSchema index_schema;
+    BTree<PageSize> btree;
+    std::string index_path;
+    size_t column_offset;
+    DataType column_type;
+    size_t value_size;
+    size_t key_size;
+
+    std::vector<char> entry(const char*) const;
+
+};
+
+#endif
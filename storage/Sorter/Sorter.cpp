@@ -0,0 +1,266 @@
+#include "Sorter.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+int order_of(uint32_t a, uint32_t b) noexcept {
+    return (a > b) - (a < b);
+}
+
+int compare_number(const char* lhs, const char* rhs) noexcept {
+    uint32_t a, b;
+    std::memcpy(&a, lhs, sizeof(a));
+    std::memcpy(&b, rhs, sizeof(b));
+    return order_of(a, b);
+}
+
+// the key is stored big-endian
+int compare_number_key(const char* lhs, const char* rhs) noexcept {
+    uint32_t a, b;
+    std::memcpy(&a, lhs, sizeof(a));
+    std::memcpy(&b, rhs, sizeof(b));
+    if constexpr(std::endian::native == std::endian::little){
+        a = std::byteswap(a);
+        b = std::byteswap(b);
+    }
+    return order_of(a, b);
+}
+
+int compare_varchar(const char* lhs, const char* rhs) noexcept {
+    return std::memcmp(lhs, rhs, MAX_STRING_LEN);
+}
+
+// reads a run back a block of records at a time
+class RunReader {
+public:
+    RunReader(const std::filesystem::path& path, size_t record_size, size_t block_records) :
+        file{ path, std::ios::binary }, path{ path }, record_size{ record_size }, block(block_records * record_size), size{ 0 }, offset{ 0 } {
+        if(!file.is_open()){
+            throw std::runtime_error(std::format("Unable to open '{}'\n", path.generic_string()));
+        }
+        refill();
+    }
+
+    const char* current() const noexcept {
+        return offset < size ? block.data() + offset : nullptr;
+    }
+
+    void advance() {
+        offset += record_size;
+        if(offset >= size) refill();
+    }
+
+private:
+    std::ifstream file;
+    std::filesystem::path path;
+    size_t record_size;
+    std::vector<char> block;
+    size_t size;
+    size_t offset;
+
+    void refill() {
+        file.read(block.data(), static_cast<std::streamsize>(block.size()));
+        size = static_cast<size_t>(file.gcount()) / record_size * record_size;
+        offset = 0;
+        if(size == 0 && file.bad()){
+            throw std::runtime_error(std::format("Unable to read '{}'\n", path.generic_string()));
+        }
+    }
+};
+
+}
+
+// the memory budget is split between the runs being merged, on equal values the earlier run wins to keep the sort stable
+struct Sorter::Merge {
+    static constexpr size_t NONE = SIZE_MAX;
+
+    const Sorter& sorter;
+    std::vector<std::unique_ptr<RunReader>> readers;
+    std::vector<size_t> heap;
+    size_t last;
+
+    Merge(const Sorter& sorter, const std::vector<std::filesystem::path>& inputs) : sorter{ sorter }, last{ NONE } {
+        const size_t block_records{ std::max<size_t>(sorter.run_capacity / (inputs.size() + 1), 1) };
+        for(const auto& path : inputs){
+            readers.push_back(std::make_unique<RunReader>(path, sorter.record_size, block_records));
+        }
+        for(size_t i = 0; i < readers.size(); ++i){
+            if(readers[i]->current() != nullptr) heap.push_back(i);
+        }
+        std::make_heap(heap.begin(), heap.end(), [this](size_t a, size_t b){ return later(a, b); });
+    }
+
+    bool later(size_t a, size_t b) const noexcept {
+        const int order{ sorter.column_compare(readers[a]->current() + sorter.column_offset, readers[b]->current() + sorter.column_offset) };
+        return order > 0 || (order == 0 && a > b);
+    }
+
+    const char* next() {
+        if(last != NONE){
+            readers[last]->advance();
+            if(readers[last]->current() != nullptr){
+                heap.push_back(last);
+                std::push_heap(heap.begin(), heap.end(), [this](size_t a, size_t b){ return later(a, b); });
+            }
+            last = NONE;
+        }
+        if(heap.empty()) return nullptr;
+        std::pop_heap(heap.begin(), heap.end(), [this](size_t a, size_t b){ return later(a, b); });
+        last = heap.back();
+        heap.pop_back();
+        return readers[last]->current();
+    }
+};
+
+// a run holds as many records as fit into the budget next to the pointers that sort them
+Sorter::Sorter(const TableSchema& table_schema, const std::string& column_name, size_t memory_budget, const std::filesystem::path& temp_path, size_t limit) :
+    record_size{ table_schema.get_record_size() }, column_offset{ table_schema.get_column_offset(column_name) },
+    run_capacity{ std::max<size_t>(memory_budget / (table_schema.get_record_size() + sizeof(const char*)), 1) },
+    temp_path{ temp_path }, run_prefix{ std::format("sort-{:08x}", std::random_device{}()) }, next_run{ 0 }, limit{ limit }, next_arrival{ 0 }, position{ 0 } {
+    const Column& column{ table_schema.get_column(column_name)->get() };
+    if(column.type == DataType::VARCHAR){
+        column_compare = compare_varchar;
+    }
+    else{
+        column_compare = column.is_key ? compare_number_key : compare_number;
+    }
+}
+
+// the readers of a merge still in progress are closed before their runs are removed
+Sorter::~Sorter() {
+    merging.reset();
+    std::error_code ignored;
+    for(const auto& path : runs){
+        std::filesystem::remove(path, ignored);
+    }
+}
+
+bool Sorter::less(const char* a, const char* b) const noexcept {
+    return column_compare(a + column_offset, b + column_offset) < 0;
+}
+
+bool Sorter::heap_less(size_t a, size_t b) const noexcept {
+    const int order{ column_compare(run.data() + a * record_size + column_offset, run.data() + b * record_size + column_offset) };
+    return order < 0 || (order == 0 && arrival[a] < arrival[b]);
+}
+
+// a row that arrives later only displaces the top of the heap when its value is strictly smaller
+void Sorter::keep(const char* record) {
+    const uint64_t order{ next_arrival++ };
+    if(heap.size() < limit){
+        const size_t slot{ heap.size() };
+        run.insert(run.end(), record, record + record_size);
+        arrival.push_back(order);
+        heap.push_back(slot);
+        std::push_heap(heap.begin(), heap.end(), [this](size_t a, size_t b){ return heap_less(a, b); });
+        return;
+    }
+    if(limit == 0 || !less(record, run.data() + heap.front() * record_size)) return;
+
+    std::pop_heap(heap.begin(), heap.end(), [this](size_t a, size_t b){ return heap_less(a, b); });
+    const size_t slot{ heap.back() };
+    std::memcpy(run.data() + slot * record_size, record, record_size);
+    arrival[slot] = order;
+    std::push_heap(heap.begin(), heap.end(), [this](size_t a, size_t b){ return heap_less(a, b); });
+}
+
+void Sorter::add(const char* record) {
+    if(limit <= run_capacity){
+        keep(record);
+        return;
+    }
+    if(run.size() == run_capacity * record_size){
+        spill();
+    }
+    run.insert(run.end(), record, record + record_size);
+}
+
+std::vector<const char*> Sorter::sorted_run() {
+    std::vector<const char*> sorted;
+    sorted.reserve(run.size() / record_size);
+    for(size_t offset = 0; offset < run.size(); offset += record_size){
+        sorted.push_back(run.data() + offset);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [this](const char* a, const char* b){ return less(a, b); });
+    return sorted;
+}
+
+std::filesystem::path Sorter::new_run_path() {
+    std::filesystem::create_directories(temp_path);
+    runs.push_back(temp_path / std::format("{}-{}.run", run_prefix, next_run++));
+    return runs.back();
+}
+
+void Sorter::spill() {
+    const std::filesystem::path path{ new_run_path() };
+    std::ofstream file{ path, std::ios::binary };
+    for(const char* record : sorted_run()){
+        file.write(record, static_cast<std::streamsize>(record_size));
+    }
+    if(!file){
+        throw std::runtime_error(std::format("Unable to write '{}'\n", path.generic_string()));
+    }
+    run.clear();
+}
+
+// the reader of the row handed out last only moves on once the caller asks for the next one
+const char* Sorter::next() {
+    if(merging){
+        return merging->next();
+    }
+    return position < sorted.size() ? sorted[position++] : nullptr;
+}
+
+// a sort that never spilled stays in memory, otherwise what is left is spilled too and the runs are merged
+void Sorter::finish() {
+    position = 0;
+    if(limit <= run_capacity){
+        std::sort(heap.begin(), heap.end(), [this](size_t a, size_t b){ return heap_less(a, b); });
+        for(size_t slot : heap){
+            sorted.push_back(run.data() + slot * record_size);
+        }
+        return;
+    }
+    if(runs.empty()){
+        sorted = sorted_run();
+        return;
+    }
+    if(!run.empty()){
+        spill();
+    }
+
+    // neighbouring runs are merged first so that equal values keep their order
+    std::vector<std::filesystem::path> pending{ runs };
+    while(pending.size() > MAX_MERGE_FANIN){
+        std::vector<std::filesystem::path> merged;
+        for(size_t first = 0; first < pending.size(); first += MAX_MERGE_FANIN){
+            const std::vector<std::filesystem::path> group{ pending.begin() + first, pending.begin() + std::min(first + MAX_MERGE_FANIN, pending.size()) };
+            const std::filesystem::path path{ new_run_path() };
+            {
+                std::ofstream file{ path, std::ios::binary };
+                Merge merge{ *this, group };
+                for(const char* record = merge.next(); record != nullptr; record = merge.next()){
+                    file.write(record, static_cast<std::streamsize>(record_size));
+                }
+                if(!file){
+                    throw std::runtime_error(std::format("Unable to write '{}'\n", path.generic_string()));
+                }
+            }
+            for(const auto& done : group){
+                std::filesystem::remove(done);
+            }
+            merged.push_back(path);
+        }
+        pending = std::move(merged);
+    }
+    merging = std::make_unique<Merge>(*this, pending);
+}
@@ -0,0 +1,63 @@
+#ifndef SORTER_HPP
+#define SORTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../SchemaCatalog/TableSchema/TableSchema.hpp"
+
+constexpr size_t DEFAULT_SORT_MEMORY = size_t{ 64 } << 20; // bytes of rows a sort keeps in memory before it spills a run
+constexpr size_t MAX_MERGE_FANIN = 64; // runs merged at once, more runs are merged in several passes
+
+// sorts records of one table by one column, stable, so rows with equal values stay in the order they were added,
+// rows past the memory budget go to sorted runs in temporary files that are merged k ways at the end,
+// when only the first limit rows are wanted and they fit the budget a bounded heap keeps just those
+class Sorter {
+public:
+    Sorter(const TableSchema&, const std::string&, size_t, const std::filesystem::path&, size_t limit = SIZE_MAX);
+    ~Sorter();
+    Sorter(const Sorter&) = delete;
+    Sorter& operator=(const Sorter&) = delete;
+
+    void add(const char*);
+    // ends adding, the rows then come out of next in order
+    void finish();
+    // nullptr once every row was handed out, a row stays valid until the following call
+    const char* next();
+
+private:
+    using Compare = int (*)(const char*, const char*) noexcept;
+
+    struct Merge;
+
+    size_t record_size;
+    size_t column_offset;
+    Compare column_compare;
+    size_t run_capacity;
+    std::filesystem::path temp_path;
+    std::string run_prefix;
+    std::vector<char> run;
+    std::vector<std::filesystem::path> runs;
+    size_t next_run;
+    size_t limit;
+    std::vector<size_t> heap;     // slots of run, the greatest row on top
+    std::vector<uint64_t> arrival; // per slot, breaks ties between equal values
+    uint64_t next_arrival;
+    std::vector<const char*> sorted; // rows of a sort that stayed in memory
+    size_t position;
+    std::unique_ptr<Merge> merging;
+
+    bool less(const char*, const char*) const noexcept;
+    bool heap_less(size_t, size_t) const noexcept;
+    void keep(const char*);
+    std::vector<const char*> sorted_run();
+    std::filesystem::path new_run_path();
+    void spill();
+
+};
+
+#endif
@@ -0,0 +1,184 @@
+#include "WriteAheadLog.hpp"
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+    #include <sys/stat.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+// FNV-1a, only used to recognize torn or partially written records
+uint32_t checksum(const WalRecordHeader& header, const char* path, const char* payload) {
+    uint32_t hash = 2166136261u;
+    auto feed = [&hash](const void* data, size_t size){
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for(size_t i = 0; i < size; ++i){
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+    };
+    feed(&header.type, sizeof(header.type));
+    feed(&header.path_len, sizeof(header.path_len));
+    feed(&header.page_id, sizeof(header.page_id));
+    feed(&header.payload_size, sizeof(header.payload_size));
+    feed(path, header.path_len);
+    feed(payload, header.payload_size);
+    return hash;
+}
+
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& wal_path) : wal_path{ wal_path }, fd{ -1 }, file_size{ 0 } {
+#ifdef _WIN32
+    fd = _open(wal_path.c_str(), _O_RDWR | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+    if(fd >= 0) file_size = static_cast<uint64_t>(_lseeki64(fd, 0, SEEK_END));
+#else
+    fd = open(wal_path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if(fd >= 0) file_size = static_cast<uint64_t>(lseek(fd, 0, SEEK_END));
+#endif
+    if(fd < 0){
+        throw std::runtime_error(std::format("Unable to open '{}'\n", wal_path));
+    }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+#ifdef _WIN32
+    _close(fd);
+#else
+    close(fd);
+#endif
+}
+
+void WriteAheadLog::append_page(const std::string& table_path, uint32_t page_id, const void* page, uint32_t page_size) {
+    append(WalRecordType::PAGE, table_path, page_id, page, page_size);
+}
+
+void WriteAheadLog::append_root(const std::string& table_path, uint32_t root_id) {
+    append(WalRecordType::ROOT, table_path, root_id, nullptr, 0);
+}
+
+// the table was truncated or removed, its earlier records must not reach whatever file has its name now
+void WriteAheadLog::append_discard(const std::string& table_path) {
+    append(WalRecordType::DISCARD, table_path, 0, nullptr, 0);
+}
+
+// one write and one fsync for everything appended since the previous commit
+void WriteAheadLog::commit() {
+    if(buffer.empty()) return;
+    append(WalRecordType::COMMIT, "", 0, nullptr, 0);
+
+    const char* data = buffer.data();
+    size_t remaining = buffer.size();
+    while(remaining > 0){
+#ifdef _WIN32
+        int n = _write(fd, data, static_cast<unsigned>(remaining));
+#else
+        ssize_t n = write(fd, data, remaining);
+#endif
+        if(n <= 0){
+            throw std::runtime_error(std::format("Unable to write '{}'\n", wal_path));
+        }
+        data += n;
+        remaining -= static_cast<size_t>(n);
+    }
+#ifdef _WIN32
+    int synced = _commit(fd);
+#else
+    int synced = fsync(fd);
+#endif
+    if(synced != 0){
+        throw std::runtime_error(std::format("Unable to sync '{}'\n", wal_path));
+    }
+    file_size += buffer.size();
+    buffer.clear();
+}
+
+// hands out the records of every fully committed group, an incomplete tail is ignored and so is every record
+// of a table that was discarded later on
+void WriteAheadLog::replay(const std::function<void(const WalRecord&)>& apply) const {
+    std::ifstream file{ wal_path, std::ios::binary };
+    if(!file.is_open()) return;
+    std::vector<char> log{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+
+    std::vector<WalRecord> committed;
+    std::unordered_map<std::string, size_t> discarded; // table path -> records committed before its last discard
+    size_t group_start{ 0 };
+    size_t offset{ 0 };
+    while(offset + sizeof(WalRecordHeader) <= log.size()){
+        WalRecordHeader header;
+        std::memcpy(&header, log.data() + offset, sizeof(header));
+        const size_t record_size{ sizeof(header) + static_cast<size_t>(header.path_len) + header.payload_size };
+        if(header.type > static_cast<uint8_t>(WalRecordType::DISCARD) || record_size > log.size() - offset){
+            break;
+        }
+        const char* path = log.data() + offset + sizeof(header);
+        const char* payload = path + header.path_len;
+        if(checksum(header, path, payload) != header.checksum){
+            break;
+        }
+        offset += record_size;
+
+        if(static_cast<WalRecordType>(header.type) == WalRecordType::COMMIT){
+            for(size_t i = group_start; i < committed.size(); ++i){
+                if(committed[i].type == WalRecordType::DISCARD){
+                    discarded[committed[i].table_path] = i;
+                }
+            }
+            group_start = committed.size();
+            continue;
+        }
+        committed.push_back(WalRecord{ static_cast<WalRecordType>(header.type), std::string{ path, header.path_len },
+            header.page_id, std::vector<char>{ payload, payload + header.payload_size } });
+    }
+    committed.resize(group_start);
+
+    for(size_t i = 0; i < committed.size(); ++i){
+        if(committed[i].type == WalRecordType::DISCARD) continue;
+        auto it = discarded.find(committed[i].table_path);
+        if(it != discarded.end() && i < it->second) continue;
+        apply(committed[i]);
+    }
+}
+
+void WriteAheadLog::truncate() {
+#ifdef _WIN32
+    int truncated = _chsize_s(fd, 0);
+#else
+    int truncated = ftruncate(fd, 0);
+#endif
+    if(truncated != 0){
+        throw std::runtime_error(std::format("Unable to truncate '{}'\n", wal_path));
+    }
+    file_size = 0;
+}
+
+bool WriteAheadLog::has_pending() const noexcept {
+    return !buffer.empty();
+}
+
+uint64_t WriteAheadLog::size() const noexcept {
+    return file_size + buffer.size();
+}
+
+void WriteAheadLog::append(WalRecordType type, const std::string& table_path, uint32_t page_id, const void* payload, uint32_t payload_size) {
+    WalRecordHeader header{ static_cast<uint8_t>(type), static_cast<uint32_t>(table_path.size()), page_id, payload_size, 0 };
+    header.checksum = checksum(header, table_path.data(), static_cast<const char*>(payload));
+
+    const char* header_bytes = reinterpret_cast<const char*>(&header);
+    const char* payload_bytes = static_cast<const char*>(payload);
+    buffer.insert(buffer.end(), header_bytes, header_bytes + sizeof(header));
+    buffer.insert(buffer.end(), table_path.begin(), table_path.end());
+    if(payload_size > 0){
+        buffer.insert(buffer.end(), payload_bytes, payload_bytes + payload_size);
+    }
+}
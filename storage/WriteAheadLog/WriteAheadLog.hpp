@@ -0,0 +1,61 @@
+#ifndef WRITE_AHEAD_LOG_HPP
+#define WRITE_AHEAD_LOG_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../storage/page.hpp"
+
+constexpr uint64_t WAL_CHECKPOINT_SIZE = uint64_t{ 8 } << 20; // log size after which pages are written back and the log truncated
+
+enum class WalRecordType : uint8_t { PAGE, ROOT, COMMIT, DISCARD };
+
+#pragma pack(push, 1)
+struct WalRecordHeader {
+    uint8_t type;
+    uint32_t path_len;
+    uint32_t page_id; // root id for ROOT records
+    uint32_t payload_size;
+    uint32_t checksum;
+};
+#pragma pack(pop)
+
+struct WalRecord {
+    WalRecordType type;
+    std::string table_path;
+    uint32_t page_id;
+    std::vector<char> payload;
+};
+
+// physical redo log, records are buffered in memory and made durable together by commit
+class WriteAheadLog {
+public:
+    explicit WriteAheadLog(const std::string&);
+    ~WriteAheadLog();
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    void append_page(const std::string&, uint32_t, const void*, uint32_t);
+    void append_root(const std::string&, uint32_t);
+    void append_discard(const std::string&);
+    void commit();
+
+    void replay(const std::function<void(const WalRecord&)>&) const;
+    void truncate();
+
+    bool has_pending() const noexcept;
+    uint64_t size() const noexcept;
+
+private:
+    std::string wal_path;
+    int fd;
+    uint64_t file_size;
+    std::vector<char> buffer;
+
+    void append(WalRecordType, const std::string&, uint32_t, const void*, uint32_t);
+
+};
+
+#endif
@@ -1,21 +1,49 @@
 #ifndef PAGE_HPP
 #define PAGE_HPP
 
+#include <algorithm>
+#include <bit>
 #include <cstdlib>
 #include <cstdint>
 #include <cstring>
+#include <format>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 
-constexpr size_t PAGE_SIZE_ = 4096;
+constexpr size_t PAGE_SIZE_ = 4096; // schema pages, table headers and the default table page size
+constexpr size_t CACHE_LINE_SIZE = 64;
 
 constexpr size_t MAX_KEY_SIZE = 21; // including '\0'
-constexpr size_t BLOCK_SIZE_ = 512;
+constexpr size_t MAX_RECORD_SIZE = 512; // largest row a table may declare
+constexpr size_t MIN_FILL_FACTOR = 10; // percent of a page bulk loads fill
+constexpr size_t MAX_FILL_FACTOR = 100;
 
 constexpr size_t MAX_TABLE_LEN = 51;
 constexpr size_t MAX_COLUMN_LEN = 21; // including '\0'
 constexpr size_t MAX_STRING_LEN = 21; // including '\0'
+constexpr size_t MAX_INDEXES = 16; // per table, they share the table's schema page
 
-constexpr size_t T = 4;
+constexpr char TABLE_MAGIC[4] = { 'M', 'D', 'B', 'T' };
+constexpr uint16_t TABLE_FORMAT_VERSION = 4;
+
+// first page of every table file, page ids are counted from the page after it
+#pragma pack(push, 1) // 4096B
+struct TableHeader {
+    char magic[sizeof(TABLE_MAGIC)];
+    uint16_t version;
+    uint8_t little_endian;
+    uint8_t reserved;
+    uint32_t root_id;
+    uint32_t page_size; // 0 in files written before page sizes were configurable
+    char alignment[PAGE_SIZE_ - sizeof(TABLE_MAGIC) - sizeof(uint16_t) - sizeof(uint8_t) * 2 - sizeof(uint32_t) * 2];
+
+    TableHeader() : version{ TABLE_FORMAT_VERSION }, little_endian{ std::endian::native == std::endian::little }, reserved{ 0 }, root_id{ 0 }, page_size{ PAGE_SIZE_ } {
+        std::memcpy(magic, TABLE_MAGIC, sizeof(magic));
+        std::memset(alignment, 0, sizeof(alignment));
+    }
+};
+#pragma pack(pop)
 
 #pragma pack(push, 1) // 4096B
 struct SchemaPage { 
@@ -29,49 +57,210 @@ struct SchemaPage {
 };
 #pragma pack(pop)
 
-#pragma pack(push, 1) //512B
-struct Block {
-    uint8_t key_type;
-    uint8_t is_deleted;
-    char key[MAX_KEY_SIZE];
-    char value[BLOCK_SIZE_ - MAX_KEY_SIZE - sizeof(key_type) - sizeof(is_deleted)];
+// widest table: longest name, narrowest columns filling a whole record, every index
+static_assert(MAX_TABLE_LEN + MAX_RECORD_SIZE / sizeof(uint32_t) * (MAX_COLUMN_LEN + 2) + 2 * sizeof(uint32_t) + MAX_INDEXES * 2 * MAX_COLUMN_LEN
+    <= sizeof(SchemaPage::data), "a table's schema has to fit its schema page");
 
-    Block() : key_type{ 0 }, is_deleted{ 0 } {
-        std::memset(key, 0, sizeof(key));
-        std::memset(value, 0, sizeof(value));
-    }
-    Block(std::string c) : key_type{ 0 }, is_deleted{ 0 } { 
-        std::memcpy(&key, c.data(), c.length());
-        std::memset(value, 0, sizeof(value));
-    }
+#pragma pack(push, 1)
+struct Slot {
+    uint16_t offset; // from the start of TablePage::data
+    uint16_t size;
 };
 #pragma pack(pop)
 
-#pragma pack(push, 1) // 4096B
+constexpr uint32_t NO_PAGE = UINT32_MAX;
+
+// B+tree page, leaves are slotted: the slot directory grows from the front of data and records are packed from the back,
+// internal pages keep three packed arrays: a normalized prefix of every separator key starting on a cache line,
+// the left child of every key and the keys themselves
+#pragma pack(push, 1) // PageSize B
+template<size_t PageSize>
 struct TablePage {
-    uint8_t n;
+    static constexpr size_t DATA_SIZE = PageSize - sizeof(uint8_t) * 2 - sizeof(uint16_t) - sizeof(uint32_t) * 4;
+    static_assert(DATA_SIZE <= UINT16_MAX, "slot offsets are 16 bit");
+    // pages are cache line aligned in memory, so this puts the prefix array on a line of its own
+    static constexpr size_t PREFIX_OFFSET = (CACHE_LINE_SIZE - (PageSize - DATA_SIZE) % CACHE_LINE_SIZE) % CACHE_LINE_SIZE;
+
     uint8_t is_leaf;
-    Block blocks[2 * T - 1]; //3584 -> T = 4
-    uint32_t children[2 * T]; //32 -> T = 4
+    uint8_t key_size;
+    uint16_t n;
     uint32_t page_id;
-    char alignment[PAGE_SIZE_ - sizeof(children) - sizeof(blocks) - sizeof(n) - sizeof(is_leaf) - sizeof(page_id)];
+    uint32_t right_child; // child after the last cell, internal pages only
+    uint32_t next_leaf;   // right sibling of a leaf, NO_PAGE for the last one
+    uint32_t heap_start;  // cells occupy data[heap_start, DATA_SIZE)
+    char data[DATA_SIZE];
 
-    TablePage() : n{ 0 }, is_leaf{ 1 }, page_id{ 0 } {
-        std::memset(blocks, 0, sizeof(blocks));
-        std::memset(children, 0, sizeof(children));
-        std::memset(alignment, 0, sizeof(alignment));
+    TablePage() : TablePage(1, 0) {}
+    TablePage(uint8_t is_leaf, uint8_t key_size) : is_leaf{ is_leaf }, key_size{ key_size }, n{ 0 }, page_id{ 0 }, right_child{ 0 }, next_leaf{ NO_PAGE }, heap_start{ DATA_SIZE } {
+        std::memset(data, 0, sizeof(data));
     }
-    TablePage(uint8_t is_leaf) : n{ 0 }, is_leaf{ is_leaf }, page_id{ 0 } {
-        std::memset(blocks, 0, sizeof(blocks));
-        std::memset(children, 0, sizeof(children));
-        std::memset(alignment, 0, sizeof(alignment));
+
+    Slot& slot_at(size_t i) noexcept {
+        return reinterpret_cast<Slot*>(data)[i];
     }
-    TablePage(uint8_t n, uint8_t is_leaf) : n{ n }, is_leaf{ is_leaf }, page_id{ 0 } {
-        std::memset(blocks, 0, sizeof(blocks));
-        std::memset(children, 0, sizeof(children));
-        std::memset(alignment, 0, sizeof(alignment));
+    const Slot& slot_at(size_t i) const noexcept {
+        return reinterpret_cast<const Slot*>(data)[i];
+    }
+    char* cell_at(size_t i) noexcept {
+        return data + slot_at(i).offset;
+    }
+    const char* cell_at(size_t i) const noexcept {
+        return data + slot_at(i).offset;
+    }
+    // records start with their key
+    const char* key_at(size_t i) const noexcept {
+        return is_leaf ? cell_at(i) : keys() + i * key_size;
+    }
+    const char* record_at(size_t i) const noexcept {
+        return cell_at(i);
+    }
+
+    // first bytes of a key as a big-endian integer with the sign bit flipped,
+    // so that signed comparison of prefixes agrees with byte-wise comparison of keys
+    static int32_t key_prefix(const char* key, size_t key_size) noexcept {
+        unsigned char bytes[sizeof(uint32_t)]{};
+        std::memcpy(bytes, key, std::min(key_size, sizeof(bytes)));
+        const uint32_t prefix{ uint32_t{ bytes[0] } << 24 | uint32_t{ bytes[1] } << 16 | uint32_t{ bytes[2] } << 8 | bytes[3] };
+        return static_cast<int32_t>(prefix ^ 0x80000000u);
+    }
+
+    // keys an internal page holds
+    static constexpr size_t capacity(size_t key_size) noexcept {
+        return (DATA_SIZE - PREFIX_OFFSET) / (sizeof(int32_t) + sizeof(uint32_t) + key_size);
+    }
+    size_t capacity() const noexcept {
+        return capacity(key_size);
+    }
+    const int32_t* prefixes() const noexcept {
+        return reinterpret_cast<const int32_t*>(data + PREFIX_OFFSET);
+    }
+
+    // child i is left of key i, child n is right_child
+    uint32_t child_at(size_t i) const noexcept {
+        if(i == n) return right_child;
+        uint32_t child;
+        std::memcpy(&child, children() + i * sizeof(uint32_t), sizeof(child));
+        return child;
+    }
+    void set_child(size_t i, uint32_t child) noexcept {
+        if(i == n){
+            right_child = child;
+            return;
+        }
+        std::memcpy(children() + i * sizeof(uint32_t), &child, sizeof(child));
+    }
+
+    // leaves only, internal pages are full once n reaches capacity()
+    bool fits(size_t cell_size) const noexcept {
+        return heap_start - n * sizeof(Slot) >= cell_size + sizeof(Slot);
+    }
+
+    // reserves a cell at slot i, the caller checks fits() and fills the returned bytes
+    char* insert_cell(size_t i, size_t cell_size) noexcept {
+        heap_start -= static_cast<uint32_t>(cell_size);
+        std::memmove(&slot_at(i + 1), &slot_at(i), (n - i) * sizeof(Slot));
+        slot_at(i) = Slot{ static_cast<uint16_t>(heap_start), static_cast<uint16_t>(cell_size) };
+        ++n;
+        return data + heap_start;
+    }
+
+    // internal pages only, key i gets child as its left child, the caller checks capacity()
+    void insert_entry(size_t i, uint32_t child, const char* key) noexcept {
+        const size_t moved{ n - i };
+        int32_t prefix{ key_prefix(key, key_size) };
+        char* prefix_data = data + PREFIX_OFFSET;
+        std::memmove(prefix_data + (i + 1) * sizeof(int32_t), prefix_data + i * sizeof(int32_t), moved * sizeof(int32_t));
+        std::memcpy(prefix_data + i * sizeof(int32_t), &prefix, sizeof(prefix));
+        std::memmove(children() + (i + 1) * sizeof(uint32_t), children() + i * sizeof(uint32_t), moved * sizeof(uint32_t));
+        std::memcpy(children() + i * sizeof(uint32_t), &child, sizeof(child));
+        std::memmove(keys() + (i + 1) * key_size, keys() + i * key_size, moved * key_size);
+        std::memcpy(keys() + i * key_size, key, key_size);
+        ++n;
+    }
+
+    // keeps the first count cells, leaves pack them against the end of the page again
+    void truncate(size_t count) {
+        if(!is_leaf){
+            const size_t removed{ n - count };
+            std::memset(data + PREFIX_OFFSET + count * sizeof(int32_t), 0, removed * sizeof(int32_t));
+            std::memset(children() + count * sizeof(uint32_t), 0, removed * sizeof(uint32_t));
+            std::memset(keys() + count * key_size, 0, removed * key_size);
+            n = static_cast<uint16_t>(count);
+            return;
+        }
+        char heap[DATA_SIZE];
+        std::memcpy(heap, data, sizeof(heap));
+        uint32_t end{ DATA_SIZE };
+        for(size_t i = 0; i < count; ++i){
+            Slot& slot = slot_at(i);
+            end -= slot.size;
+            std::memcpy(data + end, heap + slot.offset, slot.size);
+            slot.offset = static_cast<uint16_t>(end);
+        }
+        n = static_cast<uint16_t>(count);
+        heap_start = end;
+        std::memset(data + n * sizeof(Slot), 0, heap_start - n * sizeof(Slot));
+    }
+
+    // leaves only, drops the records keep rejects, packs the others against the end of the page again
+    // and returns how many were dropped
+    template<typename Keep>
+    size_t retain(Keep&& keep) {
+        char heap[DATA_SIZE];
+        std::memcpy(heap, data, sizeof(heap));
+        uint32_t end{ DATA_SIZE };
+        size_t kept{ 0 };
+        for(size_t i = 0; i < n; ++i){
+            const Slot slot = slot_at(i);
+            if(!keep(static_cast<const char*>(heap + slot.offset))) continue;
+            end -= slot.size;
+            std::memcpy(data + end, heap + slot.offset, slot.size);
+            slot_at(kept++) = Slot{ static_cast<uint16_t>(end), slot.size };
+        }
+        const size_t dropped{ n - kept };
+        n = static_cast<uint16_t>(kept);
+        heap_start = end;
+        std::memset(data + n * sizeof(Slot), 0, heap_start - n * sizeof(Slot));
+        return dropped;
+    }
+
+private:
+    char* children() noexcept {
+        return data + PREFIX_OFFSET + capacity() * sizeof(int32_t);
+    }
+    const char* children() const noexcept {
+        return data + PREFIX_OFFSET + capacity() * sizeof(int32_t);
+    }
+    char* keys() noexcept {
+        return children() + capacity() * sizeof(uint32_t);
+    }
+    const char* keys() const noexcept {
+        return children() + capacity() * sizeof(uint32_t);
     }
 };
 #pragma pack(pop)
 
+static_assert(sizeof(TablePage<PAGE_SIZE_>) == PAGE_SIZE_, "table pages must fill a page exactly");
+
+// page sizes a table can be created with, every one of them is instantiated by the storage layer
+template<typename F>
+decltype(auto) with_page_size(size_t page_size, F&& f) {
+    switch(page_size){
+        case 4096:
+            return f(std::integral_constant<size_t, 4096>{});
+        case 8192:
+            return f(std::integral_constant<size_t, 8192>{});
+        case 16384:
+            return f(std::integral_constant<size_t, 16384>{});
+        case 65536:
+            return f(std::integral_constant<size_t, 65536>{});
+        default:
+            throw std::runtime_error(std::format("Unsupported page size {}\n", page_size));
+    }
+}
+
+inline bool is_supported_page_size(size_t page_size) noexcept {
+    return page_size == 4096 || page_size == 8192 || page_size == 16384 || page_size == 65536;
+}
+
 #endif
\ No newline at end of file
@@ -40,7 +40,17 @@ const std::unordered_map<TokenType, std::string> token_type_str {
     {TokenType::NONE, "NONE"},
     {TokenType::END, "END"},
     {TokenType::PRIMARY, "PRIMARY"},
-    {TokenType::KEY, "KEY"}
+    {TokenType::KEY, "KEY"},
+    {TokenType::PAGESIZE, "PAGESIZE"},
+    {TokenType::COPY, "COPY"},
+    {TokenType::FILLFACTOR, "FILLFACTOR"},
+    {TokenType::INDEX, "INDEX"},
+    {TokenType::ON, "ON"},
+    {TokenType::OFFSET, "OFFSET"},
+    {TokenType::COUNT, "COUNT"},
+    {TokenType::SUM, "SUM"},
+    {TokenType::MIN, "MIN"},
+    {TokenType::MAX, "MAX"}
 };
 
 const std::unordered_map<GeneralTokenType, std::string> general_token_str {
@@ -51,3 +61,7 @@ const std::unordered_map<GeneralTokenType, std::string> general_token_str {
     {GeneralTokenType::LITERAL, "LITERAL"},
     {GeneralTokenType::OTHER, "OTHER"}
 };
+
+bool is_aggregate(TokenType token_type) noexcept {
+    return token_type == TokenType::COUNT || token_type == TokenType::SUM || token_type == TokenType::MIN || token_type == TokenType::MAX;
+}